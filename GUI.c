@@ -23,6 +23,21 @@ void setup_label_cb(GtkSignalListItemFactory *factory, GtkListItem *list_item, g
     gtk_list_item_set_child(list_item, label);
 }
 
+// Append empty rows to the process grid until it has 'rows' rows
+static void add_process_rows(int rows) {
+    for (int row = gui->process_rows + 1; row <= rows; row++) {
+        for (int col = 0; col < 9; col++) {
+            GtkWidget *label = gtk_label_new("");
+            gtk_widget_set_halign(label, GTK_ALIGN_START);
+            gtk_widget_set_hexpand(label, TRUE);
+            gtk_grid_attach(GTK_GRID(gui->process_grid), label, col, row, 1, 1);
+        }
+    }
+    if (rows > gui->process_rows) {
+        gui->process_rows = rows;
+    }
+}
+
 // Create the process table section
 // Create simple process display grid
 static GtkWidget* create_process_table() {
@@ -37,27 +52,21 @@ static GtkWidget* create_process_table() {
     gtk_grid_set_column_spacing(GTK_GRID(grid), 10);
     
     // Add header row (removed "Priority")
-    const char *headers[] = {"PID", "Filename", "Arrival Time", "State","PC", "CPU Time", "Waiting Time","Memory Bounds"};
-    for (int i = 0; i < 8; i++) {  // Changed from 7 to 6 columns
+    const char *headers[] = {"PID", "Filename", "Arrival Time", "State","PC", "CPU Time", "Waiting Time","Memory Bounds", "Paging"};
+    for (int i = 0; i < 9; i++) {  // Changed from 7 to 6 columns
         GtkWidget *label = gtk_label_new(headers[i]);
         gtk_widget_add_css_class(label, "header");
         gtk_grid_attach(GTK_GRID(grid), label, i, 0, 1, 1);
     }
     
-    // Create empty rows for processes
-    for (int row = 1; row <= MAX_PROCESSES; row++) {
-        for (int col = 0; col < 8; col++) {  // Changed from 7 to 6 columns
-            GtkWidget *label = gtk_label_new("");
-            gtk_widget_set_halign(label, GTK_ALIGN_START);
-            gtk_widget_set_hexpand(label, TRUE);
-            gtk_grid_attach(GTK_GRID(grid), label, col, row, 1, 1);
-        }
-    }
-    
     gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), grid);
     gtk_frame_set_child(GTK_FRAME(frame), scrolled);
     
     gui->process_grid = grid;
+    gui->process_rows = 0;
+
+    // Create empty rows for processes (more are added as the table grows)
+    add_process_rows(PROCESS_TABLE_INITIAL_SIZE);
     return frame;
 }
 
@@ -74,16 +83,18 @@ static GtkWidget* create_memory_view() {
     gtk_grid_set_column_spacing(GTK_GRID(grid), 10);
     
     // Add header row
-    const char *headers[] = {"Index", "PID", "Name", "Value"};
-    for (int i = 0; i < 4; i++) {
+    const char *headers[] = {"Index", "PID", "Name", "Value", "Frame"};
+    for (int i = 0; i < 5; i++) {
         GtkWidget *label = gtk_label_new(headers[i]);
         gtk_widget_add_css_class(label, "header");
         gtk_grid_attach(GTK_GRID(grid), label, i, 0, 1, 1);
     }
     
-    // Create empty rows for memory cells (will be filled in update_memory_view)
-    for (int row = 1; row <= 60; row++) {
-        for (int col = 0; col < 4; col++) {
+    // Create empty rows for memory cells (will be filled in update_memory_view).
+    // Large memories only show their first MEMORY_VIEW_MAX_ROWS words.
+    gui->memory_rows = memorySize < MEMORY_VIEW_MAX_ROWS ? memorySize : MEMORY_VIEW_MAX_ROWS;
+    for (int row = 1; row <= gui->memory_rows; row++) {
+        for (int col = 0; col < 5; col++) {
             GtkWidget *label = gtk_label_new("");
             gtk_widget_set_halign(label, GTK_ALIGN_START);
             gtk_widget_set_hexpand(label, TRUE);
@@ -118,9 +129,10 @@ void update_process_list(SchedulerGUI *gui) {
     GtkWidget *grid = gui->process_grid;
     if (!grid) return;
     
-    // Clear existing rows first
-    for (int row = 1; row <= MAX_PROCESSES; row++) {
-        for (int col = 0; col < 8; col++) {  // Changed from 7 to 6 columns
+    // Make room for every process, then clear existing rows
+    add_process_rows(numProcesses);
+    for (int row = 1; row <= gui->process_rows; row++) {
+        for (int col = 0; col < 9; col++) {  // Changed from 7 to 6 columns
             GtkWidget *label = gtk_grid_get_child_at(GTK_GRID(grid), col, row);
             if (GTK_IS_LABEL(label)) {
                 gtk_label_set_text(GTK_LABEL(label), "");
@@ -150,7 +162,15 @@ void update_process_list(SchedulerGUI *gui) {
         
         // State
         char *state = "NEW";
-        if (processTable[i].pcb) {
+        char swappedState[64];
+        if (processTable[i].pcb && processTable[i].pcb->waitingForDisk) {
+            snprintf(swappedState, sizeof(swappedState), "%s (I/O wait%s)", processTable[i].pcb->processState,
+                     processTable[i].pcb->resident ? "" : ", swapped");
+            state = swappedState;
+        } else if (processTable[i].pcb && !processTable[i].pcb->resident) {
+            snprintf(swappedState, sizeof(swappedState), "%s (swapped)", processTable[i].pcb->processState);
+            state = swappedState;
+        } else if (processTable[i].pcb) {
             state = processTable[i].pcb->processState;
         } else if (processTable[i].isComplete) {
             state = "TERMINATED";
@@ -175,10 +195,14 @@ void update_process_list(SchedulerGUI *gui) {
     gtk_label_set_text(GTK_LABEL(gtk_grid_get_child_at(GTK_GRID(grid), 6, row)), buffer);
 
     if (processTable[i].pcb)
-    snprintf(buffer, sizeof(buffer), "%d", processTable[i].pcb->upperMemoryBound-processTable[i].pcb->lowerMemoryBound);
+    snprintf(buffer, sizeof(buffer), "%d", pcbImageWords(processTable[i].pcb) - 1);
     else
         strcpy(buffer, "-");
     gtk_label_set_text(GTK_LABEL(gtk_grid_get_child_at(GTK_GRID(grid), 7, row)), buffer);
+
+    // Page faults, resident set and evictions (paged mode)
+    gtk_label_set_text(GTK_LABEL(gtk_grid_get_child_at(GTK_GRID(grid), 8, row)),
+                       (pagedMemory && processTable[i].pcb) ? get_paging_stats_string(processTable[i].pcb) : "-");
     }
 }
 
@@ -187,8 +211,11 @@ void update_memory_view(SchedulerGUI *gui) {
     GtkWidget *grid = gui->memory_grid;
     if (!grid) return;
     
+    // Write back PCB fields that have changed since the last refresh
+    memorySyncAll();
+    
     // Update memory cells
-    for (int i = 0; i < memorySize; i++) {
+    for (int i = 0; i < gui->memory_rows; i++) {
         int row = i + 1;
         char buffer[64];
         
@@ -198,17 +225,28 @@ void update_memory_view(SchedulerGUI *gui) {
         gtk_label_set_text(GTK_LABEL(index_label), buffer);
         
         // PID
-        snprintf(buffer, sizeof(buffer), "%d", memory[i].processID);
+        if (memory[i].processID == TEXT_OWNER_ID) {
+            snprintf(buffer, sizeof(buffer), "text");
+        } else {
+            snprintf(buffer, sizeof(buffer), "%d", memory[i].processID);
+        }
         GtkWidget *pid_label = gtk_grid_get_child_at(GTK_GRID(grid), 1, row);
         gtk_label_set_text(GTK_LABEL(pid_label), buffer);
         
         // Name
+        const char *name = memoryWordName(i, buffer, sizeof(buffer));
         GtkWidget *name_label = gtk_grid_get_child_at(GTK_GRID(grid), 2, row);
-        gtk_label_set_text(GTK_LABEL(name_label), memory[i].name ? memory[i].name : "NULL");
+        gtk_label_set_text(GTK_LABEL(name_label), name ? name : "NULL");
         
         // Value
+        const char *value = memoryWordValue(i, buffer, sizeof(buffer));
         GtkWidget *value_label = gtk_grid_get_child_at(GTK_GRID(grid), 3, row);
-        gtk_label_set_text(GTK_LABEL(value_label), memory[i].value ? memory[i].value : "NULL");
+        gtk_label_set_text(GTK_LABEL(value_label), value ? value : "NULL");
+        
+        // Frame and its owner (paged mode)
+        const char *frame = memoryWordFrame(i, buffer, sizeof(buffer));
+        GtkWidget *frame_label = gtk_grid_get_child_at(GTK_GRID(grid), 4, row);
+        gtk_label_set_text(GTK_LABEL(frame_label), frame);
     }
 }
 
@@ -363,12 +401,19 @@ static GtkWidget* create_control_panel() {
 
 // Add this new function to display output messages
 void add_output_message(SchedulerGUI *gui, const char *message) {
-    if (!gui || !gui->output_buffer || !message) {
+    if (!message) {
         return;
     }
-    
-    GtkTextIter iter;
-    gtk_text_buffer_get_end_iter(gui->output_buffer, &iter);
+    add_output_text(gui, message, strlen(message));
+}
+
+void output_line_begin(SchedulerGUI *gui, OutputLine *line) {
+    memset(line, 0, sizeof(*line));
+    line->active = gui && gui->output_buffer;
+    if (!line->active) {
+        return;
+    }
+    gtk_text_buffer_get_end_iter(gui->output_buffer, &line->iter);
     
     // Add timestamp to message
     time_t now = time(NULL);
@@ -376,15 +421,106 @@ void add_output_message(SchedulerGUI *gui, const char *message) {
     char timestamp[20];
     strftime(timestamp, sizeof(timestamp), "[%H:%M:%S] ", t);
     
-    // Create full message with timestamp 
-    char full_message[512];
-    snprintf(full_message, sizeof(full_message), "%s%s\n", timestamp, message);
+    // Each insert leaves iter after the new text
+    gtk_text_buffer_insert(gui->output_buffer, &line->iter, timestamp, -1);
+}
+
+// Insert a piece in bounded chunks. GTK only takes valid UTF-8, so invalid
+// bytes become U+FFFD; a character split between pieces is carried over.
+void output_line_append(SchedulerGUI *gui, OutputLine *line, const char *text, size_t length) {
+    static const char replacement[] = "\xEF\xBF\xBD";
+    if (!line->active) {
+        return;
+    }
+    line->length += length;
+    
+    while (line->carryLength > 0 && length > 0) {
+        line->carry[line->carryLength++] = *text++;
+        length--;
+        gunichar c = g_utf8_get_char_validated(line->carry, line->carryLength);
+        if (c == (gunichar)-2 && line->carryLength < 4) {
+            continue;
+        }
+        bool valid = c != (gunichar)-1 && c != (gunichar)-2;
+        gtk_text_buffer_insert(gui->output_buffer, &line->iter, valid ? line->carry : replacement,
+                               valid ? line->carryLength : 3);
+        line->shown += line->carryLength;
+        line->carryLength = 0;
+    }
     
-    // Insert the message at the end of the buffer
-    gtk_text_buffer_insert(gui->output_buffer, &iter, full_message, -1);
+    while (length > 0 && line->shown < OUTPUT_TEXT_LIMIT) {
+        size_t n = length < OUTPUT_CHUNK_SIZE ? length : OUTPUT_CHUNK_SIZE;
+        if (n > OUTPUT_TEXT_LIMIT - line->shown) n = OUTPUT_TEXT_LIMIT - line->shown;
+        const gchar *end;
+        g_utf8_validate(text, (gssize)n, &end);
+        size_t valid = (size_t)(end - text);
+        if (valid == 0) {
+            // A bad byte, or a character that continues in the next piece
+            gunichar c = g_utf8_get_char_validated(text, (gssize)length);
+            if (c != (gunichar)-1 && c != (gunichar)-2) {
+                break;   // a whole character that does not fit under the limit
+            }
+            if (c == (gunichar)-2 && length < 4 && text[0] != '\0') {
+                memcpy(line->carry, text, length);
+                line->carryLength = (int)length;
+                return;
+            }
+            gtk_text_buffer_insert(gui->output_buffer, &line->iter, replacement, 3);
+            valid = 1;
+        } else {
+            gtk_text_buffer_insert(gui->output_buffer, &line->iter, text, (int)valid);
+        }
+        line->shown += valid;
+        text += valid;
+        length -= valid;
+    }
+}
+
+void output_line_end(SchedulerGUI *gui, OutputLine *line) {
+    if (!line->active) {
+        return;
+    }
+    if (line->carryLength > 0) {
+        gtk_text_buffer_insert(gui->output_buffer, &line->iter, "\xEF\xBF\xBD", 3);
+        line->shown += line->carryLength;
+    }
+    if (line->shown < line->length) {
+        char marker[96];
+        snprintf(marker, sizeof(marker), "\n... (truncated, %zu of %zu bytes shown)",
+                 line->shown, line->length);
+        gtk_text_buffer_insert(gui->output_buffer, &line->iter, marker, -1);
+    }
+    gtk_text_buffer_insert(gui->output_buffer, &line->iter, "\n", 1);
     
     // Auto-scroll to the bottom
-    gtk_text_view_scroll_to_iter(GTK_TEXT_VIEW(gui->output_text_view), &iter, 0.0, FALSE, 0.0, 0.0);
+    gtk_text_view_scroll_to_iter(GTK_TEXT_VIEW(gui->output_text_view), &line->iter, 0.0, FALSE, 0.0, 0.0);
+}
+
+// Append one output line of any length: one timestamp, one scroll
+void add_output_text(SchedulerGUI *gui, const char *text, size_t length) {
+    if (!gui || !gui->output_buffer || !text) {
+        return;
+    }
+    OutputLine line;
+    output_line_begin(gui, &line);
+    output_line_append(gui, &line, text, length);
+    output_line_end(gui, &line);
+}
+
+// Append a rope's contents as one output line, chunk by chunk, never flattened
+void add_output_rope(SchedulerGUI *gui, const Rope *rope) {
+    if (!gui || !gui->output_buffer || !rope) {
+        return;
+    }
+    OutputLine line;
+    output_line_begin(gui, &line);
+    size_t offset = 0;
+    for (int i = 0; i < rope->chunkCount; i++) {
+        size_t length = i + 1 < rope->chunkCount ? ROPE_CHUNK_SIZE : rope->length - offset;
+        output_line_append(gui, &line, rope->chunks[i], length);
+        offset += length;
+    }
+    output_line_end(gui, &line);
 }
 
 // Add after create_control_panel()
@@ -575,6 +711,66 @@ static GtkWidget* create_overview_panel() {
     GtkWidget *algorithm_value = gtk_label_new("MLFQ");
     gtk_widget_set_halign(algorithm_value, GTK_ALIGN_START);
     gtk_grid_attach(GTK_GRID(overview_grid), algorithm_value, 1, row, 1, 1);
+    row++;
+    
+    // Swap activity
+    GtkWidget *swap_label = gtk_label_new("Swap:");
+    gtk_widget_set_halign(swap_label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), swap_label, 0, row, 1, 1);
+    
+    GtkWidget *swap_value = gtk_label_new("-");
+    gtk_widget_set_halign(swap_value, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), swap_value, 1, row, 1, 1);
+    row++;
+    
+    // Placement policy and fragmentation
+    GtkWidget *placement_label = gtk_label_new("Placement:");
+    gtk_widget_set_halign(placement_label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), placement_label, 0, row, 1, 1);
+    
+    GtkWidget *placement_value = gtk_label_new("-");
+    gtk_widget_set_halign(placement_value, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), placement_value, 1, row, 1, 1);
+    row++;
+    
+    // Program cache
+    GtkWidget *cache_label = gtk_label_new("Program Cache:");
+    gtk_widget_set_halign(cache_label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), cache_label, 0, row, 1, 1);
+    
+    GtkWidget *cache_value = gtk_label_new("-");
+    gtk_widget_set_halign(cache_value, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), cache_value, 1, row, 1, 1);
+    row++;
+    
+    // Instruction dispatch
+    GtkWidget *dispatch_label = gtk_label_new("Dispatch:");
+    gtk_widget_set_halign(dispatch_label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), dispatch_label, 0, row, 1, 1);
+    
+    GtkWidget *dispatch_value = gtk_label_new("-");
+    gtk_widget_set_halign(dispatch_value, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), dispatch_value, 1, row, 1, 1);
+    row++;
+    
+    // File I/O throughput
+    GtkWidget *file_io_label = gtk_label_new("File I/O:");
+    gtk_widget_set_halign(file_io_label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), file_io_label, 0, row, 1, 1);
+    
+    GtkWidget *file_io_value = gtk_label_new("-");
+    gtk_widget_set_halign(file_io_value, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), file_io_value, 1, row, 1, 1);
+    row++;
+    
+    // Simulated disk device
+    GtkWidget *disk_label = gtk_label_new("Disk:");
+    gtk_widget_set_halign(disk_label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), disk_label, 0, row, 1, 1);
+    
+    GtkWidget *disk_value = gtk_label_new("-");
+    gtk_widget_set_halign(disk_value, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(overview_grid), disk_value, 1, row, 1, 1);
     
     gtk_box_append(GTK_BOX(main_box), overview_grid);
     gtk_frame_set_child(GTK_FRAME(frame), main_box);
@@ -704,6 +900,42 @@ void update_overview_panel(SchedulerGUI *gui) {
         }
         gtk_label_set_text(GTK_LABEL(algorithm_value), algo_text);
     }
+    
+    // Update swap activity
+    GtkWidget *swap_value = gtk_grid_get_child_at(GTK_GRID(overview_grid), 1, 3);
+    if (swap_value) {
+        gtk_label_set_text(GTK_LABEL(swap_value), get_swap_stats_string());
+    }
+    
+    // Update placement telemetry
+    GtkWidget *placement_value = gtk_grid_get_child_at(GTK_GRID(overview_grid), 1, 4);
+    if (placement_value) {
+        gtk_label_set_text(GTK_LABEL(placement_value), get_placement_stats_string());
+    }
+    
+    // Update program cache counters
+    GtkWidget *cache_value = gtk_grid_get_child_at(GTK_GRID(overview_grid), 1, 5);
+    if (cache_value) {
+        gtk_label_set_text(GTK_LABEL(cache_value), get_program_cache_stats_string());
+    }
+    
+    // Update dispatch counters
+    GtkWidget *dispatch_value = gtk_grid_get_child_at(GTK_GRID(overview_grid), 1, 6);
+    if (dispatch_value) {
+        gtk_label_set_text(GTK_LABEL(dispatch_value), get_dispatch_stats_string());
+    }
+    
+    // Update file I/O throughput
+    GtkWidget *file_io_value = gtk_grid_get_child_at(GTK_GRID(overview_grid), 1, 7);
+    if (file_io_value) {
+        gtk_label_set_text(GTK_LABEL(file_io_value), get_file_io_stats_string());
+    }
+    
+    // Update disk device
+    GtkWidget *disk_value = gtk_grid_get_child_at(GTK_GRID(overview_grid), 1, 8);
+    if (disk_value) {
+        gtk_label_set_text(GTK_LABEL(disk_value), get_disk_stats_string());
+    }
 }
 
 // Add a function to update the queue panel
@@ -841,10 +1073,11 @@ void update_queue_panel(SchedulerGUI *gui) {
             const char* instr = "Unknown";
             
             // Get the current instruction if valid PC
-            if (pc >= currentRunningProcess->lowerMemoryBound && 
-                pc < currentRunningProcess->upperMemoryBound - 9) {
+            if (pc >= 0 && pc < pcbInstructionCount(currentRunningProcess) &&
+                pcbPageLoaded(currentRunningProcess, pc)) {
+                int index = pcbAddress(currentRunningProcess, pc);
                 // if(pc==0)
-                    instr = memory[pc].value ? memory[pc].value : "Unknown";
+                    instr = memoryWordText(index) ? memoryWordText(index) : "Unknown";
                 // else
                 //     instr = memory[pc-1].value ? memory[pc-1].value : "Unknown";
             }
@@ -944,29 +1177,20 @@ void update_queue_panel(SchedulerGUI *gui) {
     GtkWidget *blocked_info = gtk_widget_get_first_child(blocked_box);
     
     if (blocked_info) {
-        // Count blocked processes across all resources
+        // Count blocked processes across all resources (only the first 5 are shown)
         int blocked_count = 0;
-        PCB* blocked_processes[50]; // Assuming max 50 processes could be blocked
-        
-        // Check file mutex
-        PCB *current = fileMutex.blockedQueue;
-        while (current) {
-            blocked_processes[blocked_count++] = current;
-            current = current->next;
-        }
+        PCB* blocked_processes[5];
+        Mutex *mutexes[] = {&fileMutex, &inputMutex, &outputMutex};
         
-        // Check input mutex
-        current = inputMutex.blockedQueue;
-        while (current) {
-            blocked_processes[blocked_count++] = current;
-            current = current->next;
-        }
-        
-        // Check output mutex
-        current = outputMutex.blockedQueue;
-        while (current) {
-            blocked_processes[blocked_count++] = current;
-            current = current->next;
+        for (int m = 0; m < 3; m++) {
+            PCB *current = mutexes[m]->blockedQueue;
+            while (current) {
+                if (blocked_count < 5) {
+                    blocked_processes[blocked_count] = current;
+                }
+                blocked_count++;
+                current = current->next;
+            }
         }
         
         if (blocked_count > 0) {
@@ -1410,6 +1634,9 @@ void gui_run_full_simulation(SchedulerGUI *gui) {
 }
 // Main function
 int main(int argc, char *argv[]) {
+    // Simulator options (memory size, ...) must be set before the window is built
+    parse_simulator_options(&argc, argv);
+
     // Create the application
     app = gtk_application_new("com.example.osscheduler", G_APPLICATION_DEFAULT_FLAGS);
     g_signal_connect(app, "activate", G_CALLBACK(app_activate), NULL);
@@ -35,8 +35,29 @@ typedef struct {
     GtkTextBuffer *output_buffer;
     GtkWidget *mlfq_frame;   
     GtkWidget *ready_frame;
+    int process_rows;        // rows currently in process_grid
+    int memory_rows;         // rows shown in memory_grid
 } SchedulerGUI;
 
+// The memory viewer shows at most this many words
+#define MEMORY_VIEW_MAX_ROWS 1024
+
+// Output text reaches the text buffer in inserts of at most this many bytes,
+// and one message shows at most OUTPUT_TEXT_LIMIT bytes of it
+#define OUTPUT_CHUNK_SIZE (64 * 1024)
+#define OUTPUT_TEXT_LIMIT (4 * 1024 * 1024)
+
+// One output line appended in pieces: output_line_begin, any number of
+// output_line_append, then output_line_end
+typedef struct {
+    GtkTextIter iter;        // end of the text inserted so far
+    size_t length;           // bytes offered
+    size_t shown;            // bytes inserted, at most OUTPUT_TEXT_LIMIT
+    char carry[4];           // start of a character cut off at the end of the last piece
+    int carryLength;
+    bool active;             // false when there is no output view
+} OutputLine;
+
 // Add the function prototypes
 void update_overview_panel(SchedulerGUI *gui);
 void update_queue_panel(SchedulerGUI *gui);
@@ -65,6 +86,12 @@ void update_queue_panel(SchedulerGUI *gui);
 // Add this to GUI.h after other function declarations
 void show_input_dialog(const char *var_name, bool numeric_only);
 void add_output_message(SchedulerGUI *gui, const char *message);
+void add_output_text(SchedulerGUI *gui, const char *text, size_t length);
+struct Rope;
+void add_output_rope(SchedulerGUI *gui, const struct Rope *rope);
+void output_line_begin(SchedulerGUI *gui, OutputLine *line);
+void output_line_append(SchedulerGUI *gui, OutputLine *line, const char *text, size_t length);
+void output_line_end(SchedulerGUI *gui, OutputLine *line);
 
 
 
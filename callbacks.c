@@ -204,7 +204,7 @@ void on_input_dialog_ok(GtkButton *button, gpointer user_data) {
     
     if (valid) {
         // Apply the input value
-        setVariable(pending_input_var, text);
+        setVariable(pending_input_process, pending_input_var, text);
         
         // Log the action safely
         if (gui && gui->log_buffer) {
@@ -213,43 +213,10 @@ void on_input_dialog_ok(GtkButton *button, gpointer user_data) {
             log_message(gui, message);
         }
         
-        // Update memory for the variable with safety checks
+        // Update memory for the variable
         if (pending_input_process != NULL) {
-            int found = 0;
-            int start = pending_input_process->lowerMemoryBound;
-            int end = pending_input_process->upperMemoryBound - 6;
-            
-            // Bounds check to prevent segfault
-            if (start >= 0 && end < memorySize && start < end) {
-                for (int i = start + (end - start - 3); i < end; i++) {
-                    if (i >= 0 && i < memorySize && memory[i].name != NULL) {
-                        if ((strcmp(memory[i].name, "Variable") == 0 && 
-                             memory[i].value != NULL && strcmp(memory[i].value, "NULL") == 0) ||
-                            (strcmp(memory[i].name, pending_input_var) == 0)) {
-                            
-                            // Update variable name if needed
-                            if (strcmp(memory[i].name, "Variable") == 0) {
-                                char *new_name = strdup(pending_input_var);
-                                if (new_name) {
-                                    free(memory[i].name);
-                                    memory[i].name = new_name;
-                                }
-                            }
-                            
-                            // Update variable value
-                            if (memory[i].value != NULL) {
-                                free(memory[i].value);
-                            }
-                            
-                            memory[i].value = strdup(text);
-                            found = 1;
-                            break;
-                        }
-                    }
-                }
-            }
-            
-            if (!found && gui && gui->log_buffer) {
+            if (!memoryStoreVariable(pending_input_process, pending_input_var, text) &&
+                gui && gui->log_buffer) {
                 log_message(gui, "Warning: Variable location not found in memory");
             }
         }
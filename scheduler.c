@@ -7,6 +7,10 @@
 #include <time.h>
 #include <ctype.h>
 #include <stdarg.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
 #include "GUI.h" 
 #include "scheduler.h"
 
@@ -18,16 +22,15 @@ PCB* pending_input_process = NULL;
  // Default quantum for Round Robin
 
 memoryWord *memory ;
-int memorySize = 60;
+int memorySize = MIN_MEMORY_SIZE;
 ProcessTableEntry* processTable = NULL;
+int processTableCapacity = 0;
 int numProcesses = 0;
 Queue readyQueue = {NULL, NULL};
 MLFQScheduler mlfqScheduler;
 SchedulingAlgorithm algorithm = FCFS;
 int currentTime = -1;
 int processCount = 0;
-Variable variables[MAX_VARIABLES];
-int var_count = 0;
 Mutex fileMutex, inputMutex, outputMutex;
 PCB* currentRunningProcess = NULL;
 bool simulationPaused = false;
@@ -91,222 +94,2894 @@ PCB* dequeue(Queue* q) {
 
 //================================ Memory Management ===========================
 
-// Initialize memory
-void initialMemory() {
-    if (memory == NULL) {   
-        memorySize = 60; 
-        memory = (memoryWord*)malloc(memorySize * sizeof(memoryWord));
-        if (memory == NULL) {
-            fprintf(stderr, "Failed to allocate memory\n");
-            log_message(gui, "Failed to allocate memory\n");
+// Allocator state: an occupancy bitmap (one bit per word) plus a list of free
+// extents kept sorted by address. Allocation walks the free extents only.
+uint64_t *memoryBitmap = NULL;
+memoryExtent *freeExtents = NULL;
+int freeExtentCount = 0;
+int freeExtentCapacity = 0;
+memoryRegion *processRegions = NULL; // indexed by process ID
+int processRegionCapacity = 0;
+int memoryFreeWords = 0;
+int memoryCompactions = 0;
+long long memoryWordsCompacted = 0;
+
+// Placement: which free extent a contiguous image goes into. The buddy
+// allocator keeps its own free lists, one per power-of-two block size.
+PlacementPolicy placementPolicy = PLACE_FIRST_FIT;
+PlacementStats placementStats;
+static int nextFitRover = 0;           // address after the previous placement
+#define BUDDY_ORDERS 32
+static int* buddyFree[BUDDY_ORDERS];   // start addresses of free 2^order blocks
+static int buddyFreeCount[BUDDY_ORDERS];
+static int buddyFreeCapacity[BUDDY_ORDERS];
+
+// Paged mode: memory is split into frames of pageSize words and each process
+// image is spread over any free frames through its page table. Frames are
+// tracked in their own bitmap; memoryBitmap still marks their words as used.
+bool pagedMemory = false;
+int pageSize = 16;
+static int pageShift = 4;
+int frameCount = 0;
+pageFrame* frames = NULL;
+static uint64_t* frameBitmap = NULL;
+static int frameSearchHint = 0;
+
+// Demand paging: instruction pages are loaded on their first fetch and may be
+// evicted; pages holding variables or PCB words are loaded up front and pinned.
+bool demandPaging = false;
+PageReplacementPolicy pageReplacement = REPLACE_LRU;
+int pageFaultCycles = 3;
+int workingSetWindow = 10;
+static int evictableFrames = 0;        // loaded frames that are not pinned
+static long long frameLoadCount = 0;
+static long long frameReferenceCount = 0;
+static int clockHand = 0;
+static PCB* pageWaitList = NULL;       // faulting processes, sorted by wakeTime
+
+// Mark words [start, start+length) as used or free, one 64-bit word at a time
+static void bitmap_set_range(int start, int length, bool used) {
+    int end = start + length;
+    while (start < end) {
+        int bit = start & 63;
+        int count = (end - start < 64 - bit) ? end - start : 64 - bit;
+        uint64_t mask = (count == 64) ? ~0ULL : (((1ULL << count) - 1) << bit);
+        if (used) {
+            memoryBitmap[start >> 6] |= mask;
+        } else {
+            memoryBitmap[start >> 6] &= ~mask;
+        }
+        start += count;
+    }
+}
+
+// Number of occupied memory words
+int memoryUsedWords() {
+    int used = 0;
+    int words = (memorySize + 63) / 64;
+    for (int i = 0; i < words; i++) {
+        used += __builtin_popcountll(memoryBitmap[i]);
+    }
+    return used;
+}
+
+// Index of the first occupied word at or after 'from', or -1 if there is none
+int memoryNextUsedWord(int from) {
+    if (from >= memorySize) return -1;
+    int word = from >> 6;
+    uint64_t bits = memoryBitmap[word] & (~0ULL << (from & 63));
+    int words = (memorySize + 63) / 64;
+    while (bits == 0) {
+        if (++word >= words) return -1;
+        bits = memoryBitmap[word];
+    }
+    int index = (word << 6) + __builtin_ctzll(bits);
+    return (index < memorySize) ? index : -1;
+}
+
+//================================ Ropes ===========================
+
+static Rope* rope_new() {
+    Rope* rope = (Rope*)calloc(1, sizeof(Rope));
+    if (rope) rope->refCount = 1;
+    return rope;
+}
+
+// Read a whole file into a rope, one chunk at a time (NULL if out of memory)
+Rope* ropeReadFile(FILE* file) {
+    Rope* rope = rope_new();
+    int capacity = 0;
+    while (rope != NULL) {
+        // One spare byte so a single-chunk rope is already a C string
+        char* chunk = (char*)malloc(ROPE_CHUNK_SIZE + 1);
+        if (chunk == NULL) {
+            ropeRelease(rope);
+            return NULL;
+        }
+        size_t length = fread(chunk, 1, ROPE_CHUNK_SIZE, file);
+        if (length == 0 && rope->chunkCount > 0) {
+            free(chunk);
+            break;
+        }
+        if (rope->chunkCount == capacity) {
+            capacity = capacity ? capacity * 2 : 4;
+            char** grown = (char**)realloc(rope->chunks, capacity * sizeof(char*));
+            if (!grown) {
+                free(chunk);
+                ropeRelease(rope);
+                return NULL;
+            }
+            rope->chunks = grown;
+        }
+        chunk[length] = '\0';
+        rope->chunks[rope->chunkCount++] = chunk;
+        rope->length += length;
+        if (length < ROPE_CHUNK_SIZE) break;
+    }
+    return rope;
+}
+
+Rope* ropeRetain(Rope* rope) {
+    rope->refCount++;
+    return rope;
+}
+
+void ropeRelease(Rope* rope) {
+    if (rope == NULL || --rope->refCount > 0) return;
+    for (int i = 0; i < rope->chunkCount; i++) {
+        free(rope->chunks[i]);
+    }
+    free(rope->chunks);
+    free(rope->flat);
+    free(rope);
+}
+
+// Copy the rope's chunks to 'out' as one C string (length + 1 bytes)
+static void rope_copy(const Rope* rope, char* out) {
+    size_t offset = 0;
+    for (int i = 0; i < rope->chunkCount; i++) {
+        size_t length = i + 1 < rope->chunkCount ? ROPE_CHUNK_SIZE : rope->length - offset;
+        memcpy(out + offset, rope->chunks[i], length);
+        offset += length;
+    }
+    out[rope->length] = '\0';
+}
+
+// The rope as one C string; only ropes of several chunks are copied.
+// Returns NULL if there is no memory for the copy.
+const char* ropeText(Rope* rope) {
+    if (rope->chunkCount == 1) {
+        return rope->chunks[0];
+    }
+    if (rope->flat == NULL) {
+        rope->flat = (char*)malloc(rope->length + 1);
+        if (rope->flat == NULL) {
+            printf("Error: No memory to flatten a %zu-byte file\n", rope->length);
+            return NULL;
+        }
+        rope_copy(rope, rope->flat);
+    }
+    return rope->flat;
+}
+
+// Write the rope's chunks out in place
+bool ropeWrite(const Rope* rope, FILE* file) {
+    size_t offset = 0;
+    for (int i = 0; i < rope->chunkCount; i++) {
+        size_t length = i + 1 < rope->chunkCount ? ROPE_CHUNK_SIZE : rope->length - offset;
+        if (fwrite(rope->chunks[i], 1, length, file) != length) return false;
+        offset += length;
+    }
+    return true;
+}
+
+//================================ Memory Words ===========================
+
+// Interned word names; ids below NAME_FIRST_DYNAMIC are fixed (see scheduler.h)
+static char** internedNames = NULL;
+static int internedCount = 0;
+static int internedCapacity = 0;
+static uint16_t* internHash = NULL;   // open addressing, 0 = empty slot
+static int internHashSize = 0;
+
+static unsigned int hash_string(const char* s) {
+    unsigned int h = 2166136261u;
+    while (*s) {
+        h = (h ^ (unsigned char)*s++) * 16777619u;
+    }
+    return h;
+}
+
+// Reserve id 0 for "no name" and register the fixed names in order
+static bool intern_init() {
+    static const char* fixedNames[] = {
+        "", "Instruction", "Variable", "PCB_ID", "processState",
+        "currentPriority", "programCounter", "lowerMemoryBound", "upperMemoryBound"
+    };
+    internedCapacity = 64;
+    internedNames = (char**)malloc(internedCapacity * sizeof(char*));
+    internHashSize = 128;
+    internHash = (uint16_t*)calloc(internHashSize, sizeof(uint16_t));
+    if (!internedNames || !internHash) {
+        printf("Error: Failed to allocate name table\n");
+        return false;
+    }
+    internedNames[internedCount++] = strdup("");
+    for (int i = 1; i < NAME_FIRST_DYNAMIC; i++) {
+        intern_name(fixedNames[i]);
+    }
+    return true;
+}
+
+// Id of 'name' if it has been interned, else -1. Reads use this so names
+// that are only ever looked up never take a place in the table.
+int intern_lookup(const char* name) {
+    if (internedCount == 0 && !intern_init()) {
+        return -1;
+    }
+    unsigned int slot = hash_string(name) & (internHashSize - 1);
+    while (internHash[slot] != 0) {
+        if (strcmp(internedNames[internHash[slot]], name) == 0) {
+            return internHash[slot];
+        }
+        slot = (slot + 1) & (internHashSize - 1);
+    }
+    return -1;
+}
+
+// Return the id of 'name', adding it to the table if it is new
+int intern_name(const char* name) {
+    if (internedCount == 0 && !intern_init()) {
+        return NAME_NONE;
+    }
+
+    unsigned int slot = hash_string(name) & (internHashSize - 1);
+    while (internHash[slot] != 0) {
+        if (strcmp(internedNames[internHash[slot]], name) == 0) {
+            return internHash[slot];
+        }
+        slot = (slot + 1) & (internHashSize - 1);
+    }
+
+    if (internedCount >= UINT16_MAX) {
+        printf("Error: Too many distinct names\n");
+        return NAME_NONE;
+    }
+    if (internedCount == internedCapacity) {
+        char** grown = (char**)realloc(internedNames, internedCapacity * 2 * sizeof(char*));
+        if (!grown) return NAME_NONE;
+        internedNames = grown;
+        internedCapacity *= 2;
+    }
+    int id = internedCount++;
+    internedNames[id] = strdup(name);
+    internHash[slot] = id;
+
+    // Keep the hash at most half full
+    if (internedCount * 2 > internHashSize) {
+        free(internHash);
+        internHashSize *= 2;
+        internHash = (uint16_t*)calloc(internHashSize, sizeof(uint16_t));
+        for (int i = 1; i < internedCount; i++) {
+            unsigned int s = hash_string(internedNames[i]) & (internHashSize - 1);
+            while (internHash[s] != 0) s = (s + 1) & (internHashSize - 1);
+            internHash[s] = i;
+        }
+    }
+    return id;
+}
+
+// Name for an interned id
+const char* interned_name(int id) {
+    if (id <= NAME_NONE || id >= internedCount) return "";
+    return internedNames[id];
+}
+
+// Drop what a word's value owns
+static void memory_word_release(memoryWord* word) {
+    if (word->kind == WORD_HEAP) {
+        free(word->value.heap);
+    } else if (word->kind == WORD_ROPE) {
+        ropeRelease(word->value.rope);
+    }
+    word->kind = WORD_EMPTY;
+}
+
+// Release a word's value and mark it free
+void memoryClearWord(int index) {
+    memory_word_release(&memory[index]);
+    memory[index].processID = -1;
+    memory[index].nameID = NAME_NONE;
+    memory[index].nameIndex = 0;
+    memory[index].kind = WORD_EMPTY;
+}
+
+// Store a string; short strings are kept inline in the word
+void memoryWriteString(int index, int processID, int nameID, const char* value) {
+    memoryWord* word = &memory[index];
+    size_t length = strlen(value);
+    if (word->kind != WORD_HEAP || length < WORD_INLINE_SIZE || strcmp(word->value.heap, value) != 0) {
+        memory_word_release(word);
+    }
+    if (length < WORD_INLINE_SIZE) {
+        memcpy(word->value.text, value, length + 1);
+        word->kind = WORD_INLINE;
+    } else if (word->kind != WORD_HEAP) {
+        word->value.heap = strdup(value);
+        word->kind = WORD_HEAP;
+    }
+    word->processID = processID;
+    word->nameID = nameID;
+}
+
+// Store a string that outlives the word (program text in a process arena).
+// Long strings are referenced rather than copied.
+void memoryWriteText(int index, int processID, int nameID, const char* text) {
+    memoryWord* word = &memory[index];
+    size_t length = strlen(text);
+    if (length < WORD_INLINE_SIZE) {
+        memoryWriteString(index, processID, nameID, text);
+        return;
+    }
+    memory_word_release(word);
+    word->value.heap = (char*)text;
+    word->kind = WORD_TEXT;
+    word->processID = processID;
+    word->nameID = nameID;
+}
+
+// Store an integer value
+void memoryWriteInt(int index, int processID, int nameID, int64_t value) {
+    memoryWord* word = &memory[index];
+    memory_word_release(word);
+    word->value.number = value;
+    word->kind = WORD_INT;
+    word->processID = processID;
+    word->nameID = nameID;
+}
+
+// True if 'text' is an integer that prints back the same (e.g. "42", "-7")
+static bool canonical_integer(const char* text, long long* number) {
+    char* end;
+    char canonical[24];
+    *number = strtoll(text, &end, 10);
+    if (*text == '\0' || *end != '\0') {
+        return false;
+    }
+    snprintf(canonical, sizeof(canonical), "%lld", *number);
+    return strcmp(canonical, text) == 0;
+}
+
+// Store a value, keeping canonical integers as numbers
+void memoryWriteValue(int index, int processID, int nameID, const char* value) {
+    long long number;
+    if (canonical_integer(value, &number)) {
+        memoryWriteInt(index, processID, nameID, number);
+        return;
+    }
+    memoryWriteString(index, processID, nameID, value);
+}
+
+// Store a reference to a rope; the word keeps it alive
+void memoryWriteRope(int index, int processID, int nameID, Rope* rope) {
+    memoryWord* word = &memory[index];
+    ropeRetain(rope);
+    memory_word_release(word);
+    word->value.rope = rope;
+    word->kind = WORD_ROPE;
+    word->processID = processID;
+    word->nameID = nameID;
+}
+
+// Text of a string word, or NULL if the word is empty, holds a number or
+// is a rope there was no memory to flatten
+const char* memoryWordText(int index) {
+    switch (memory[index].kind) {
+        case WORD_INLINE: return memory[index].value.text;
+        case WORD_HEAP:
+        case WORD_TEXT: return memory[index].value.heap;
+        case WORD_ROPE: return ropeText(memory[index].value.rope);
+        default: return NULL;
+    }
+}
+
+// Printable name of a word, or NULL if the word is free
+const char* memoryWordName(int index, char* buffer, size_t size) {
+    if (memory[index].nameID == NAME_NONE) return NULL;
+    if (memory[index].nameID == NAME_INSTRUCTION) {
+        snprintf(buffer, size, "Instruction %d", memory[index].nameIndex);
+        return buffer;
+    }
+    return interned_name(memory[index].nameID);
+}
+
+// Printable value of a word, or NULL if the word is free
+const char* memoryWordValue(int index, char* buffer, size_t size) {
+    if (memory[index].kind == WORD_INT) {
+        snprintf(buffer, size, "%lld", (long long)memory[index].value.number);
+        return buffer;
+    }
+    return memoryWordText(index);
+}
+
+// PCB fields are authoritative in the PCB struct. In write-back mode the
+// mirrored memory words are only marked dirty and are written when memory
+// is observed (memory viewer) or the process is switched in or out.
+bool pcbWriteBack = true;
+
+// Note that PCB fields changed, writing them through unless in write-back mode
+void pcbMarkDirty(PCB* pcb, unsigned int fields) {
+    pcb->dirtyFields |= fields;
+    if (!pcbWriteBack) {
+        memorySyncPCB(pcb);
+    }
+}
+
+// Change a process state
+void pcbSetState(PCB* pcb, const char* state) {
+    strcpy(pcb->processState, state);
+    pcbMarkDirty(pcb, PCB_DIRTY_STATE);
+}
+
+// Write a PCB's dirty fields to its memory words
+void memorySyncPCB(PCB* pcb) {
+    if (!pcb->resident) {
+        return;  // written when the image is swapped back in
+    }
+    if (pcb->dirtyFields & PCB_DIRTY_STATE) {
+        memoryWriteString(pcbAddress(pcb, pcbImageWords(pcb) - 5), pcb->processID, NAME_PROCESS_STATE, pcb->processState);
+    }
+    if (pcb->dirtyFields & PCB_DIRTY_COUNTER) {
+        memoryWriteInt(pcbAddress(pcb, pcbImageWords(pcb) - 3), pcb->processID, NAME_PROGRAM_COUNTER, pcb->programCounter);
+    }
+    pcb->dirtyFields = 0;
+}
+
+// Bring every resident process's memory words up to date
+void memorySyncAll() {
+    for (int i = 0; i < numProcesses; i++) {
+        if (processTable[i].pcb != NULL && processTable[i].pcb->dirtyFields != 0) {
+            memorySyncPCB(processTable[i].pcb);
+        }
+    }
+}
+
+// The variable word holding 'nameID', else the first unused one (-1 if full)
+static int variable_word(PCB* process, int nameID) {
+    int firstFree = -1;
+    int firstVariable = pcbInstructionCount(process);
+    for (int offset = firstVariable; offset < firstVariable + PROCESS_VARIABLE_WORDS; offset++) {
+        int i = pcbAddress(process, offset);
+        if (memory[i].nameID == nameID) {
+            return i;
+        }
+        if (memory[i].nameID == NAME_VARIABLE && firstFree == -1) {
+            firstFree = i;
+        }
+    }
+    return firstFree;
+}
+
+// Store a variable's value in one of the process's 3 variable words
+bool memoryStoreVariable(PCB* process, const char* varName, const char* value) {
+    int nameID = intern_name(varName);
+    int i = variable_word(process, nameID);
+    if (i == -1) {
+        return false;
+    }
+    memoryWriteValue(i, process->processID, nameID, value);
+    return true;
+}
+
+// Store into the variable word chosen at load time (slot -1 or a word
+// another name took means search). Numbers and ropes are not copied as text.
+bool memoryStoreVariableAt(PCB* process, int slot, int nameID, const Value* value) {
+    int i = slot >= 0 ? pcbAddress(process, pcbInstructionCount(process) + slot) : -1;
+    if (i == -1 || (memory[i].nameID != nameID && memory[i].nameID != NAME_VARIABLE)) {
+        i = variable_word(process, nameID);
+        if (i == -1) {
+            return false;
+        }
+    }
+    switch (value->kind) {
+        case VALUE_INT: memoryWriteInt(i, process->processID, nameID, value->data.number); break;
+        case VALUE_INLINE: memoryWriteString(i, process->processID, nameID, value->data.text); break;
+        case VALUE_SHARED: memoryWriteString(i, process->processID, nameID, value->data.shared->text); break;
+        case VALUE_ROPE: memoryWriteRope(i, process->processID, nameID, value->data.rope); break;
+        default: return false;
+    }
+    return true;
+}
+
+//================================ Memory Allocation ===========================
+
+// Insert a free extent into a sorted extent list, merging it with its neighbours
+static void extent_insert(memoryExtent** list, int* count, int* capacity, int start, int length) {
+    memoryExtent* extents = *list;
+    int n = *count;
+
+    // Binary search for the first extent after 'start'
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (extents[mid].start < start) lo = mid + 1;
+        else hi = mid;
+    }
+
+    bool mergePrev = lo > 0 && extents[lo-1].start + extents[lo-1].length == start;
+    bool mergeNext = lo < n && start + length == extents[lo].start;
+
+    if (mergePrev && mergeNext) {
+        extents[lo-1].length += length + extents[lo].length;
+        memmove(&extents[lo], &extents[lo+1], (n - lo - 1) * sizeof(memoryExtent));
+        *count = --n;
+    } else if (mergePrev) {
+        extents[lo-1].length += length;
+    } else if (mergeNext) {
+        extents[lo].start = start;
+        extents[lo].length += length;
+    } else {
+        if (n == *capacity) {
+            int newCapacity = *capacity ? *capacity * 2 : 16;
+            memoryExtent* grown = (memoryExtent*)realloc(extents, newCapacity * sizeof(memoryExtent));
+            if (!grown) {
+                printf("Error: Failed to grow free extent list\n");
+                return;
+            }
+            *list = extents = grown;
+            *capacity = newCapacity;
+        }
+        memmove(&extents[lo+1], &extents[lo], (n - lo) * sizeof(memoryExtent));
+        extents[lo].start = start;
+        extents[lo].length = length;
+        *count = ++n;
+    }
+}
+
+// Take 'length' units from the front of extent i
+static int extent_carve(memoryExtent* list, int* count, int i, int length) {
+    int start = list[i].start;
+    list[i].start += length;
+    list[i].length -= length;
+    if (list[i].length == 0) {
+        memmove(&list[i], &list[i+1], (*count - i - 1) * sizeof(memoryExtent));
+        (*count)--;
+    }
+    return start;
+}
+
+// Take 'length' units from the first extent large enough; -1 if none is
+static int extent_take(memoryExtent* list, int* count, int length) {
+    for (int i = 0; i < *count; i++) {
+        if (list[i].length >= length) {
+            return extent_carve(list, count, i, length);
+        }
+    }
+    return -1;
+}
+
+static void free_extent_insert(int start, int length) {
+    extent_insert(&freeExtents, &freeExtentCount, &freeExtentCapacity, start, length);
+}
+
+// Pick a free extent for 'length' words according to placementPolicy and
+// carve the words out of it. Adds the extents examined to *searched.
+static int free_extent_place(int length, long long* searched) {
+    int chosen = -1;
+    if (placementPolicy == PLACE_NEXT_FIT) {
+        // Resume at the first extent starting at or after the rover
+        int lo = 0, hi = freeExtentCount;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (freeExtents[mid].start < nextFitRover) lo = mid + 1;
+            else hi = mid;
+        }
+        for (int n = 0; n < freeExtentCount && chosen == -1; n++) {
+            int i = (lo + n) % freeExtentCount;
+            (*searched)++;
+            if (freeExtents[i].length >= length) chosen = i;
+        }
+    } else {
+        for (int i = 0; i < freeExtentCount; i++) {
+            (*searched)++;
+            if (freeExtents[i].length < length) continue;
+            if (placementPolicy == PLACE_FIRST_FIT) {
+                chosen = i;
+                break;
+            }
+            if (chosen == -1 ||
+                (placementPolicy == PLACE_BEST_FIT && freeExtents[i].length < freeExtents[chosen].length) ||
+                (placementPolicy == PLACE_WORST_FIT && freeExtents[i].length > freeExtents[chosen].length)) {
+                chosen = i;
+                if (placementPolicy == PLACE_BEST_FIT && freeExtents[i].length == length) break;
+            }
+        }
+    }
+    if (chosen == -1) {
+        return -1;
+    }
+    int start = extent_carve(freeExtents, &freeExtentCount, chosen, length);
+    nextFitRover = start + length;
+    return start;
+}
+
+// Smallest buddy order whose blocks hold 'words' words
+static int buddy_order(int words) {
+    int order = 0;
+    while ((1 << order) < words) order++;
+    return order;
+}
+
+static void buddy_push(int order, int start) {
+    if (buddyFreeCount[order] == buddyFreeCapacity[order]) {
+        int newCapacity = buddyFreeCapacity[order] ? buddyFreeCapacity[order] * 2 : 16;
+        int* grown = (int*)realloc(buddyFree[order], newCapacity * sizeof(int));
+        if (!grown) {
+            printf("Error: Failed to grow buddy free list\n");
             return;
         }
-    for (int i = 0; i < 60; i++) {
-        memory[i].name = NULL;
-        memory[i].value = NULL;
-        memory[i].processID = -1;
+        buddyFree[order] = grown;
+        buddyFreeCapacity[order] = newCapacity;
+    }
+    buddyFree[order][buddyFreeCount[order]++] = start;
+}
+
+static bool buddy_remove(int order, int start) {
+    for (int i = 0; i < buddyFreeCount[order]; i++) {
+        if (buddyFree[order][i] == start) {
+            buddyFree[order][i] = buddyFree[order][--buddyFreeCount[order]];
+            return true;
+        }
+    }
+    return false;
+}
+
+// Split the whole memory into the largest aligned power-of-two blocks
+static void buddy_reset() {
+    for (int order = 0; order < BUDDY_ORDERS; order++) {
+        buddyFreeCount[order] = 0;
+    }
+    int start = 0;
+    while (start < memorySize) {
+        int order = 0;
+        while (order + 1 < BUDDY_ORDERS && (start & ((2 << order) - 1)) == 0 &&
+               start + (2 << order) <= memorySize) {
+            order++;
+        }
+        buddy_push(order, start);
+        start += 1 << order;
+    }
+}
+
+// Take a block for 'words' words, splitting a larger one if needed
+static int buddy_take(int words, long long* searched) {
+    int want = buddy_order(words);
+    int order = want;
+    while ((1 << order) <= memorySize) {
+        (*searched)++;
+        if (buddyFreeCount[order] > 0) break;
+        order++;
+    }
+    if ((1 << order) > memorySize) {
+        return -1;
+    }
+    int start = buddyFree[order][--buddyFreeCount[order]];
+    while (order > want) {
+        order--;
+        buddy_push(order, start + (1 << order));  // upper half stays free
+    }
+    return start;
+}
+
+// Return a block, merging it with its buddy for as long as the buddy is free
+static void buddy_release(int start, int length) {
+    int order = buddy_order(length);
+    while (order + 1 < BUDDY_ORDERS) {
+        int buddy = start ^ (1 << order);
+        if (buddy + (1 << order) > memorySize || !buddy_remove(order, buddy)) break;
+        if (buddy < start) start = buddy;
+        order++;
+    }
+    buddy_push(order, start);
+}
+
+// Words a request for 'words' words actually occupies
+static int placement_size(int words) {
+    return placementPolicy == PLACE_BUDDY ? 1 << buddy_order(words) : words;
+}
+
+// Give back a region taken by memory_allocate_words
+static void memory_release_region(int start, int length) {
+    if (placementPolicy == PLACE_BUDDY) {
+        buddy_release(start, length);
+    } else {
+        free_extent_insert(start, length);
+    }
+}
+
+// Largest run of free words a single allocation could use
+int memoryLargestFreeBlock() {
+    if (pagedMemory) {
+        return memoryFreeWords;  // any free frames will do
+    }
+    int largest = 0;
+    if (placementPolicy == PLACE_BUDDY) {
+        for (int order = BUDDY_ORDERS - 1; order >= 0; order--) {
+            if (buddyFreeCount[order] > 0) return 1 << order;
+        }
+        return 0;
+    }
+    for (int i = 0; i < freeExtentCount; i++) {
+        if (freeExtents[i].length > largest) largest = freeExtents[i].length;
+    }
+    return largest;
+}
+
+// Size the frame table for the current memory and mark every frame free.
+// Words past the last whole frame are never handed out.
+static void frame_table_reset() {
+    frameCount = memorySize >> pageShift;
+    int bitmapWords = (frameCount + 63) / 64;
+    free(frames);
+    free(frameBitmap);
+    frames = (pageFrame*)malloc(frameCount * sizeof(pageFrame));
+    frameBitmap = (uint64_t*)calloc(bitmapWords, sizeof(uint64_t));
+    if (!frames || !frameBitmap) {
+        printf("Error: Failed to allocate frame table\n");
+        frameCount = 0;
+        memoryFreeWords = 0;
+        return;
+    }
+    for (int i = 0; i < frameCount; i++) {
+        frames[i].owner = -1;
+        frames[i].page = -1;
+        frames[i].process = NULL;
+    }
+    // Bits past the last frame count as used so searches never return them
+    if (frameCount & 63) {
+        frameBitmap[bitmapWords - 1] = ~0ULL << (frameCount & 63);
+    }
+    frameSearchHint = 0;
+    evictableFrames = 0;
+    clockHand = 0;
+    memoryFreeWords = frameCount << pageShift;
+}
+
+// Index of a free frame, or -1 if every frame is in use
+static int frame_find_free() {
+    int bitmapWords = (frameCount + 63) / 64;
+    for (int n = 0; n < bitmapWords; n++) {
+        int word = (frameSearchHint + n) % bitmapWords;
+        uint64_t freeBits = ~frameBitmap[word];
+        if (freeBits != 0) {
+            frameSearchHint = word;
+            return (word << 6) + __builtin_ctzll(freeBits);
+        }
+    }
+    return -1;
+}
+
+// Hand a free frame to page 'page' of a process
+static void frame_assign(int frame, PCB* pcb, int page, bool pinned) {
+    frameBitmap[frame >> 6] |= 1ULL << (frame & 63);
+    frames[frame].owner = pcb->processID;
+    frames[frame].page = page;
+    frames[frame].process = pcb;
+    frames[frame].loadedAt = ++frameLoadCount;
+    frames[frame].lastUse = ++frameReferenceCount;
+    frames[frame].lastUseTime = currentTime;
+    frames[frame].referenced = true;
+    frames[frame].pinned = pinned;
+    bitmap_set_range(frame << pageShift, pageSize, true);
+    memoryFreeWords -= pageSize;
+    if (!pinned) evictableFrames++;
+    pcb->pageTable[page] = frame;
+    pcb->residentPages++;
+    if (pcb->residentPages > pcb->peakResidentPages) {
+        pcb->peakResidentPages = pcb->residentPages;
+    }
+}
+
+// Clear a frame's words and return it to the free frames
+static void frame_release(int frame) {
+    int base = frame << pageShift;
+    for (int i = base; i < base + pageSize; i++) {
+        memoryClearWord(i);
+    }
+    bitmap_set_range(base, pageSize, false);
+    frameBitmap[frame >> 6] &= ~(1ULL << (frame & 63));
+    if (!frames[frame].pinned) evictableFrames--;
+    frames[frame].process->pageTable[frames[frame].page] = -1;
+    frames[frame].process->residentPages--;
+    frames[frame].owner = -1;
+    frames[frame].page = -1;
+    frames[frame].process = NULL;
+    memoryFreeWords += pageSize;
+}
+
+// Pick the loaded, unpinned frame to evict according to pageReplacement
+static int frame_choose_victim() {
+    if (evictableFrames == 0) {
+        return -1;
+    }
+    if (pageReplacement == REPLACE_CLOCK) {
+        // Sweep, clearing reference bits, until an unreferenced page turns up
+        for (;;) {
+            int frame = clockHand;
+            clockHand = (clockHand + 1) % frameCount;
+            if (frames[frame].owner == -1 || frames[frame].pinned) continue;
+            if (!frames[frame].referenced) return frame;
+            frames[frame].referenced = false;
+        }
+    }
+
+    int victim = -1;
+    long long oldest = 0;
+    for (int frame = 0; frame < frameCount; frame++) {
+        if (frames[frame].owner == -1 || frames[frame].pinned) continue;
+        if (pageReplacement == REPLACE_WORKING_SET &&
+            currentTime - frames[frame].lastUseTime > workingSetWindow) {
+            return frame;  // no longer in its owner's working set
+        }
+        long long age = pageReplacement == REPLACE_FIFO ? frames[frame].loadedAt : frames[frame].lastUse;
+        if (victim == -1 || age < oldest) {
+            victim = frame;
+            oldest = age;
+        }
+    }
+    return victim;
+}
+
+// A free frame, evicting a page if there is none; -1 if nothing can be evicted
+static int frame_allocate() {
+    int frame = frame_find_free();
+    if (frame == -1 && demandPaging) {
+        frame = frame_choose_victim();
+        if (frame != -1) {
+            PCB* owner = frames[frame].process;
+            printf("Evicting page %d of process %d from frame %d\n", frames[frame].page, owner->processID, frame);
+            owner->pageEvictions++;
+            frame_release(frame);
+        }
+    }
+    return frame;
+}
+
+// Pages of an image that hold only instructions and so can be loaded lazily
+static int lazy_pages(int words) {
+    return demandPaging ? (words - PROCESS_IMAGE_OVERHEAD) >> pageShift : 0;
+}
+
+// Give a process frames for an image of 'words' words. With demand paging
+// only the pages holding variables and PCB words get frames now.
+static bool memory_allocate_frames(PCB* pcb, int words) {
+    int pages = (words + pageSize - 1) >> pageShift;
+    int lazy = lazy_pages(words);
+    if (((pages - lazy) << pageShift) > memoryFreeWords + (evictableFrames << pageShift)) {
+        return false;
+    }
+    pcb->pageTable = (int*)malloc(pages * sizeof(int));
+    if (!pcb->pageTable) {
+        printf("Error: Failed to allocate page table\n");
+        return false;
+    }
+    pcb->pageCount = pages;
+    pcb->residentPages = 0;
+    for (int page = 0; page < pages; page++) {
+        pcb->pageTable[page] = -1;
+    }
+    for (int page = lazy; page < pages; page++) {
+        int frame = frame_allocate();
+        if (frame == -1) {
+            memoryFreeImage(pcb);
+            return false;
+        }
+        frame_assign(frame, pcb, page, true);
+    }
+    return true;
+}
+
+// Switch to paged memory with frames of 'words' words. Only allowed while no
+// process is resident.
+int set_page_size(int words) {
+    if (words < 1 || words > MAX_PAGE_SIZE || (words & (words - 1)) != 0) {
+        printf("Invalid page size %d (must be a power of two up to %d words)\n", words, MAX_PAGE_SIZE);
+        return -1;
+    }
+    if (memory != NULL && memoryUsedWords() > 0) {
+        printf("Cannot change the page size while processes are resident\n");
+        return -1;
+    }
+    pagedMemory = true;
+    pageSize = words;
+    pageShift = __builtin_ctz(words);
+    if (memory != NULL) {
+        memoryResetAllocator();
+    }
+    printf("Paged memory with %d-word pages\n", pageSize);
+    return 0;
+}
+
+// Reset the allocator so that the whole memory is one free extent
+void memoryResetAllocator() {
+    memset(memoryBitmap, 0, ((memorySize + 63) / 64) * sizeof(uint64_t));
+    freeExtentCount = 0;
+    free_extent_insert(0, memorySize);
+    if (placementPolicy == PLACE_BUDDY) {
+        buddy_reset();
+    }
+    nextFitRover = 0;
+    memoryFreeWords = memorySize;
+    for (int i = 0; i < processRegionCapacity; i++) {
+        processRegions[i].start = -1;
+        processRegions[i].length = 0;
+    }
+    if (pagedMemory) {
+        frame_table_reset();
+    }
+}
+
+// Initialize memory
+void initialMemory() {
+    if (memory == NULL) {   
+        memory = (memoryWord*)malloc(memorySize * sizeof(memoryWord));
+        memoryBitmap = (uint64_t*)calloc((memorySize + 63) / 64, sizeof(uint64_t));
+        if (memory == NULL || memoryBitmap == NULL) {
+            fprintf(stderr, "Failed to allocate memory\n");
+            log_message(gui, "Failed to allocate memory\n");
+            return;
+        }
+    memset(memory, 0, memorySize * sizeof(memoryWord));
+    for (int i = 0; i < memorySize; i++) {
+        memory[i].processID = -1;
+    }
+    memoryResetAllocator();
+}
+}
+
+// Change the number of memory words. Only allowed while no process is resident.
+int set_memory_size(int words) {
+    if (words < MIN_MEMORY_SIZE || words > MAX_MEMORY_SIZE) {
+        printf("Invalid memory size %d (must be %d to %d words)\n", words, MIN_MEMORY_SIZE, MAX_MEMORY_SIZE);
+        return -1;
+    }
+    if (memory != NULL) {
+        if (memoryUsedWords() > 0) {
+            printf("Cannot resize memory while processes are resident\n");
+            return -1;
+        }
+        free(memory);
+        free(memoryBitmap);
+        memory = NULL;
+        memoryBitmap = NULL;
+    }
+    memorySize = words;
+    initialMemory();
+    printf("Memory size set to %d words\n", memorySize);
+    return 0;
+}
+
+// Change where contiguous images are placed. Only allowed while no process is
+// resident, since the buddy allocator keeps its own free lists.
+int set_placement_policy(PlacementPolicy policy) {
+    if (memory != NULL && memoryUsedWords() > 0) {
+        printf("Cannot change the placement policy while processes are resident\n");
+        return -1;
+    }
+    placementPolicy = policy;
+    memset(&placementStats, 0, sizeof(placementStats));
+    if (memory != NULL) {
+        memoryResetAllocator();
+    }
+    return 0;
+}
+
+// Release every occupied memory word and reset the allocator
+void memoryClear() {
+    if (memory == NULL) return;
+    for (int i = memoryNextUsedWord(0); i != -1; i = memoryNextUsedWord(i + 1)) {
+        memoryClearWord(i);
+    }
+    memoryResetAllocator();
+    memset(&placementStats, 0, sizeof(placementStats));
+    swapReset();
+    pageWaitList = NULL;
+}
+
+// Carve 'bytes' bytes, aligned for pointers, out of a process arena,
+// growing it if it is full. Only safe while nothing points into the arena.
+static void* arena_alloc(ProcessArena* arena, size_t bytes) {
+    size_t start = (arena->used + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    if (start + bytes > arena->size) {
+        size_t newSize = arena->size ? arena->size * 2 : 256;
+        while (newSize < start + bytes) newSize *= 2;
+        char* grown = (char*)realloc(arena->base, newSize);
+        if (!grown) {
+            return NULL;
+        }
+        arena->base = grown;
+        arena->size = newSize;
+    }
+    arena->used = start + bytes;
+    return arena->base + start;
+}
+
+// Drop everything allocated from an arena at once
+static void arena_release(ProcessArena* arena) {
+    free(arena->base);
+    if (arena->mapping != NULL) {
+        munmap(arena->mapping, arena->mappingSize);
+    }
+    memset(arena, 0, sizeof(*arena));
+}
+
+// Read a program file in one pass. The file is mapped copy-on-write and each
+// newline is overwritten with a terminator, so instructions are views into
+// the mapping; only the line table lives in the arena. Blank lines and
+// '#' comments are skipped. Returns the number of instructions, or -1.
+int readProgramFile(const char* fileName, ProcessArena* arena, char*** instructions) {
+    memset(arena, 0, sizeof(*arena));
+    *instructions = NULL;
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd == -1) {
+        printf("Failed to open file: %s\n", fileName);
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        printf("Failed to open file: %s\n", fileName);
+        close(fd);
+        return -1;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t)info.st_size;
+    char* text = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (text == MAP_FAILED) {
+        printf("Failed to map file: %s\n", fileName);
+        return -1;
+    }
+    arena->mapping = text;
+    arena->mappingSize = size;
+
+    // The line table is the only thing in the arena, so it can grow in place
+    int IC = 0;
+    const char* end = text + size;
+    char* line = text;
+    char* unterminated = NULL;
+    while (line < end) {
+        char* newline = (char*)memchr(line, '\n', end - line);
+        if (*line != '\n' && *line != '#') {
+            char** slot = (char**)arena_alloc(arena, sizeof(char*));
+            if (!slot) {
+                printf("Memory allocation failed\n");
+                log_message(gui, "Memory allocation failed\n");
+                arena_release(arena);
+                return -1;
+            }
+            *slot = line;
+            IC++;
+            if (newline == NULL) unterminated = line;
+        }
+        if (newline == NULL) break;
+        *newline = '\0';
+        line = newline + 1;
+    }
+
+    // An unterminated last line has no newline to overwrite, so it is copied
+    if (unterminated != NULL) {
+        size_t length = end - unterminated;
+        char* copy = (char*)arena_alloc(arena, length + 1);
+        if (!copy) {
+            printf("Memory allocation failed\n");
+            log_message(gui, "Memory allocation failed\n");
+            arena_release(arena);
+            return -1;
+        }
+        memcpy(copy, unterminated, length);
+        copy[length] = '\0';
+        ((char**)arena->base)[IC - 1] = copy;
+    }
+    *instructions = (char**)arena->base;
+    return IC;
+}
+
+// Take 'placeNeeded' words where placementPolicy puts them and mark them used.
+// The buddy allocator rounds the block up to a power of two; *length gets the
+// words actually taken.
+static int memory_place(int placeNeeded, int* length) {
+    long long searched = 0;
+    int firstFree;
+    if (placementPolicy == PLACE_BUDDY) {
+        firstFree = buddy_take(placeNeeded, &searched);
+    } else {
+        firstFree = free_extent_place(placeNeeded, &searched);
+    }
+    placementStats.blocksSearched += searched;
+    if (firstFree == -1) {
+        placementStats.failures++;
+        return -1;
+    }
+    *length = placement_size(placeNeeded);
+    placementStats.allocations++;
+    placementStats.wastedWords += *length - placeNeeded;
+    bitmap_set_range(firstFree, *length, true);
+    memoryFreeWords -= *length;
+    return firstFree;
+}
+
+// Clear the words of a placed block and give it back
+static void memory_unplace(int start, int length) {
+    for (int i = start; i < start + length; i++) {
+        memoryClearWord(i);
+    }
+    bitmap_set_range(start, length, false);
+    memory_release_region(start, length);
+    memoryFreeWords += length;
+}
+
+// Allocate 'placeNeeded' words for a process and record them as its region
+static int memory_allocate_words(int processID, int placeNeeded) {
+    int length;
+    int firstFree = memory_place(placeNeeded, &length);
+    if (firstFree == -1) {
+        return -1;
+    }
+
+    // Remember the region so it can be released without scanning memory
+    if (processID >= processRegionCapacity) {
+        int newCapacity = processRegionCapacity ? processRegionCapacity : 16;
+        while (newCapacity <= processID) newCapacity *= 2;
+        memoryRegion* grown = (memoryRegion*)realloc(processRegions, newCapacity * sizeof(memoryRegion));
+        if (!grown) {
+            printf("Error: Failed to grow process region table\n");
+            memory_unplace(firstFree, length);
+            return -1;
+        }
+        for (int j = processRegionCapacity; j < newCapacity; j++) {
+            grown[j].start = -1;
+            grown[j].length = 0;
+        }
+        processRegions = grown;
+        processRegionCapacity = newCapacity;
+    }
+    processRegions[processID].start = firstFree;
+    processRegions[processID].length = length;
+    return firstFree;  // Return the first free memory location found
+}
+
+// Allocate memory for process
+int memoryAllocate(int processID, int IC) {
+    return memory_allocate_words(processID, IC + PROCESS_IMAGE_OVERHEAD);  // Instructions + var + PCB entries
+}
+
+// Free memory allocated for process
+void memorydeallocate(int processID) {
+    if (processID < 0 || processID >= processRegionCapacity || processRegions[processID].length == 0) {
+        return;
+    }
+
+    int start = processRegions[processID].start;
+    int length = processRegions[processID].length;
+    memory_unplace(start, length);
+    processRegions[processID].start = -1;
+    processRegions[processID].length = 0;
+
+    printf("Freed memory words %d to %d\n", start, start + length - 1);
+}
+
+// Shared text: in contiguous mode processes running the same cached program
+// use one read-only copy of its instructions. Their own region holds only
+// the variables and PCB words.
+bool shareText = true;
+static TextSegment** textSegments = NULL;
+static int textSegmentCount = 0;
+static int textSegmentCapacity = 0;
+
+// Segment starting at memory word 'start', or NULL
+static TextSegment* text_segment_at(int start) {
+    for (int i = 0; i < textSegmentCount; i++) {
+        if (textSegments[i]->start == start) return textSegments[i];
+    }
+    return NULL;
+}
+
+// Take a reference on the text of program 'programID', loading it into
+// memory if no process is using it yet. 'owner' is never swapped out to
+// make room. Returns NULL if there is no room.
+static TextSegment* text_segment_acquire(int programID, char** lines, int count, PCB* owner) {
+    for (int i = 0; i < textSegmentCount; i++) {
+        if (textSegments[i]->programID == programID) {
+            textSegments[i]->refCount++;
+            return textSegments[i];
+        }
+    }
+    if (textSegmentCount == textSegmentCapacity) {
+        int newCapacity = textSegmentCapacity ? textSegmentCapacity * 2 : 8;
+        TextSegment** grown = (TextSegment**)realloc(textSegments, newCapacity * sizeof(TextSegment*));
+        if (!grown) return NULL;
+        textSegments = grown;
+        textSegmentCapacity = newCapacity;
+    }
+    TextSegment* text = (TextSegment*)malloc(sizeof(TextSegment));
+    if (!text) return NULL;
+
+    int length;
+    int start = memory_place(count, &length);
+    if (start == -1 && memoryMakeRoom(count, owner)) {
+        start = memory_place(count, &length);
+    }
+    if (start == -1) {
+        free(text);
+        return NULL;
+    }
+    // The segment outlives the process that loaded it, so its words own
+    // their strings rather than pointing into that process's arena, and
+    // are tagged with the text owner rather than that process's id
+    for (int j = 0; j < count; j++) {
+        memoryWriteString(start + j, TEXT_OWNER_ID, NAME_INSTRUCTION, lines[j]);
+        memory[start + j].nameIndex = j;
+    }
+    text->programID = programID;
+    text->start = start;
+    text->length = count;
+    text->regionLength = length;
+    text->refCount = 1;
+    textSegments[textSegmentCount++] = text;
+    printf("Loaded shared text of %d words at memory words %d to %d\n", count, start, start + count - 1);
+    return text;
+}
+
+// Drop a reference; the last one frees the segment's words
+static void text_segment_release(TextSegment* text) {
+    if (--text->refCount > 0) {
+        return;
+    }
+    memory_unplace(text->start, text->regionLength);
+    for (int i = 0; i < textSegmentCount; i++) {
+        if (textSegments[i] == text) {
+            textSegments[i] = textSegments[--textSegmentCount];
+            break;
+        }
+    }
+    printf("Freed shared text at memory words %d to %d\n", text->start, text->start + text->length - 1);
+    free(text);
+}
+
+// Memory words saved by sharing: every user past the first would need a copy
+static int text_segment_words_saved() {
+    int saved = 0;
+    for (int i = 0; i < textSegmentCount; i++) {
+        saved += (textSegments[i]->refCount - 1) * textSegments[i]->length;
+    }
+    return saved;
+}
+
+// Slide every resident process image and shared text segment down to the
+// lowest addresses so that all free words form a single extent. Processes are
+// addressed relative to lowerMemoryBound and their segment's start, so only
+// those need to change. Returns the number of
+// clock cycles the copy costs.
+int memoryCompact() {
+    if (pagedMemory) {
+        return 0;  // paging has no external fragmentation to remove
+    }
+    if (placementPolicy == PLACE_BUDDY) {
+        return 0;  // blocks must stay aligned; coalescing is the buddy defragmenter
+    }
+    PCB** owners = (PCB**)calloc(processRegionCapacity > 0 ? processRegionCapacity : 1, sizeof(PCB*));
+    if (!owners) {
+        printf("Error: Failed to allocate compaction table\n");
+        return 0;
+    }
+    for (int i = 0; i < numProcesses; i++) {
+        PCB* pcb = processTable[i].pcb;
+        if (pcb != NULL && pcb->processID < processRegionCapacity) {
+            owners[pcb->processID] = pcb;
+        }
+    }
+
+    // The bitmap still describes the old layout while images are moved, and
+    // images only move down, so the scan never reads a word already written
+    int next = 0;
+    int scanEnd = 0;
+    long long moved = 0;
+    for (int i = memoryNextUsedWord(0); i != -1; i = memoryNextUsedWord(scanEnd)) {
+        int pid = memory[i].processID;
+        TextSegment* text = text_segment_at(i);
+        int length = text ? text->regionLength : processRegions[pid].length;
+        scanEnd = i + length;
+        if (i != next) {
+            memmove(&memory[next], &memory[i], length * sizeof(memoryWord));
+            moved += length;
+            if (text != NULL) {
+                text->start = next;  // users translate through the segment
+                next += length;
+                continue;
+            }
+            processRegions[pid].start = next;
+
+            PCB* pcb = owners[pid];
+            if (pcb != NULL) {
+                pcb->lowerMemoryBound += next - i;
+                pcb->upperMemoryBound += next - i;
+                memoryWriteInt(pcb->upperMemoryBound - 1, pid, NAME_LOWER_MEMORY_BOUND, pcb->lowerMemoryBound);
+                memoryWriteInt(pcb->upperMemoryBound, pid, NAME_UPPER_MEMORY_BOUND, pcb->upperMemoryBound);
+            }
+        }
+        next += length;
+    }
+    free(owners);
+
+    // Words past the last image were moved out (their values now belong to
+    // the moved copies), so reset them without freeing anything
+    if (scanEnd > next) {
+        memset(&memory[next], 0, (scanEnd - next) * sizeof(memoryWord));
+        for (int i = next; i < scanEnd; i++) {
+            memory[i].processID = -1;
+        }
+    }
+    bitmap_set_range(0, memorySize, false);
+    bitmap_set_range(0, next, true);
+    freeExtentCount = 0;
+    if (next < memorySize) {
+        free_extent_insert(next, memorySize - next);
+    }
+
+    int cycles = (int)((moved + COMPACTION_WORDS_PER_CYCLE - 1) / COMPACTION_WORDS_PER_CYCLE);
+    memoryCompactions++;
+    memoryWordsCompacted += moved;
+    printf("Compacted memory: moved %lld words in %d cycles, %d words free\n", moved, cycles, memoryFreeWords);
+    return cycles;
+}
+
+// Give a process room for an image of 'words' words, swapping out or
+// compacting if necessary, and set its bounds
+bool memoryAllocateImage(PCB* pcb, int words) {
+    if (pagedMemory) {
+        int neededWords = words - (lazy_pages(words) << pageShift);
+        if (!memory_allocate_frames(pcb, words) &&
+            !(memoryMakeRoom(neededWords, pcb) && memory_allocate_frames(pcb, words))) {
+            return false;
+        }
+        pcb->lowerMemoryBound = 0;  // addresses are logical and go through the page table
+    } else {
+        words -= pcb->text ? pcb->text->length : 0;  // shared text is already resident
+        int p = memory_allocate_words(pcb->processID, words);
+        if (p == -1 && memoryMakeRoom(words, pcb)) {
+            p = memory_allocate_words(pcb->processID, words);
+        }
+        if (p == -1) {
+            return false;
+        }
+        pcb->lowerMemoryBound = p;
+    }
+    pcb->upperMemoryBound = pcb->lowerMemoryBound + words - 1;
+    return true;
+}
+
+// Release a process image in either memory mode
+void memoryFreeImage(PCB* pcb) {
+    if (!pagedMemory) {
+        memorydeallocate(pcb->processID);
+        return;
+    }
+    if (pcb->pageTable == NULL) {
+        return;
+    }
+    printf("Freed %d frames of process %d\n", pcb->residentPages, pcb->processID);
+    for (int page = 0; page < pcb->pageCount; page++) {
+        if (pcb->pageTable[page] != -1) {
+            frame_release(pcb->pageTable[page]);
+        }
+    }
+    free(pcb->pageTable);
+    pcb->pageTable = NULL;
+    pcb->pageCount = 0;
+}
+
+// Frame holding a memory word and who owns it, for the memory viewer
+const char* memoryWordFrame(int index, char* buffer, size_t size) {
+    if (!pagedMemory) {
+        return "-";
+    }
+    int frame = index >> pageShift;
+    if (frame >= frameCount) {
+        return "unused";
+    }
+    if (frames[frame].owner == -1) {
+        snprintf(buffer, size, "%d (free)", frame);
+    } else {
+        snprintf(buffer, size, "%d (P%d page %d)", frame, frames[frame].owner, frames[frame].page);
+    }
+    return buffer;
+}
+
+// Whether the page holding 'offset' is in memory
+bool pcbPageLoaded(PCB* pcb, int offset) {
+    return !pagedMemory || pcb->pageTable[offset >> pageShift] != -1;
+}
+
+// Record an instruction fetch at 'offset'. Returns false if its page is not
+// loaded, in which case the caller raises a page fault. A page pinned by its
+// fault becomes evictable once the process has fetched from it.
+bool memoryTouchPage(PCB* pcb, int offset) {
+    if (!pagedMemory) {
+        return true;
+    }
+    pcb->pageReferences++;
+    int frame = pcb->pageTable[offset >> pageShift];
+    if (frame == -1) {
+        return false;
+    }
+    frames[frame].lastUse = ++frameReferenceCount;
+    frames[frame].lastUseTime = currentTime;
+    frames[frame].referenced = true;
+    if (frames[frame].pinned && (offset >> pageShift) < lazy_pages(pcbImageWords(pcb))) {
+        frames[frame].pinned = false;
+        evictableFrames++;
+    }
+    return true;
+}
+
+// Load an instruction page from the program text
+static bool memory_load_page(PCB* pcb, int page, bool pinned) {
+    int frame = frame_allocate();
+    if (frame == -1 && memoryMakeRoom(pageSize, pcb)) {
+        frame = frame_allocate();
+    }
+    if (frame == -1) {
+        return false;
+    }
+    frame_assign(frame, pcb, page, pinned);
+    int first = page << pageShift;
+    for (int offset = first; offset < first + pageSize && offset < pcb->programLines; offset++) {
+        int i = pcbAddress(pcb, offset);
+        memoryWriteText(i, pcb->processID, NAME_INSTRUCTION, pcb->programText[offset]);
+        memory[i].nameIndex = offset;
+    }
+    return true;
+}
+
+// Service a fault on the page at the program counter. The page is loaded now
+// but the process stays blocked for pageFaultCycles, as if waiting for the disk.
+// The page stays pinned until the process runs again so that other faults
+// cannot steal it in the meantime and thrash forever.
+void memoryPageFault(PCB* pcb) {
+    int page = pcb->programCounter >> pageShift;
+    pcb->pageFaults++;
+    if (!memory_load_page(pcb, page, true)) {
+        printf("No frame for page %d of process %d, it will fault again\n", page, pcb->processID);
+    }
+    pcbSetState(pcb, "BLOCKED");
+    pcb->blockedSince = currentTime;
+    pcb->wakeTime = currentTime + pageFaultCycles;
+
+    PCB** link = &pageWaitList;
+    while (*link != NULL && (*link)->wakeTime <= pcb->wakeTime) {
+        link = &(*link)->next;
+    }
+    pcb->next = *link;
+    *link = pcb;
+    printf("Time %d: Process %d page fault on page %d, blocked until %d\n",
+           currentTime, pcb->processID, page, pcb->wakeTime);
+}
+
+// Make processes whose page faults have been serviced ready again
+void check_page_fault_completions() {
+    while (pageWaitList != NULL && pageWaitList->wakeTime <= currentTime) {
+        PCB* pcb = pageWaitList;
+        pageWaitList = pcb->next;
+        pcb->next = NULL;
+        printf("Time %d: Process %d page fault serviced\n", currentTime, pcb->processID);
+        make_ready(pcb);
+    }
+}
+
+// Release everything a finished process holds: its image and program text
+void memoryReleaseProcess(PCB* pcb) {
+    if (pagedMemory) {
+        printf("Process %d paging: %s\n", pcb->processID, get_paging_stats_string(pcb));
+    }
+    memorySwapDiscard(pcb);
+    memoryFreeImage(pcb);
+    if (pcb->text != NULL) {
+        text_segment_release(pcb->text);
+        pcb->text = NULL;
+    }
+    arena_release(&pcb->arena);
+    pcb->programText = NULL;
+    pcb->programLines = 0;
+    pcb->code = NULL;
+    pcb->operands = NULL;
+    variableScopeFree(&pcb->variables);
+}
+
+// Translate a process-relative address into a memory index
+int pcbAddress(PCB* pcb, int offset) {
+    if (pagedMemory) {
+        return (pcb->pageTable[offset >> pageShift] << pageShift) | (offset & (pageSize - 1));
+    }
+    if (pcb->text != NULL) {
+        if (offset < pcb->text->length) {
+            return pcb->text->start + offset;
+        }
+        offset -= pcb->text->length;
+    }
+    return pcb->lowerMemoryBound + offset;
+}
+
+// Words in a process image: instructions, 3 variables and 6 PCB words
+int pcbImageWords(PCB* pcb) {
+    return pcb->upperMemoryBound - pcb->lowerMemoryBound + 1 + (pcb->text ? pcb->text->length : 0);
+}
+
+// Number of instruction words at the start of a process image
+int pcbInstructionCount(PCB* pcb) {
+    return pcbImageWords(pcb) - PROCESS_IMAGE_OVERHEAD;
+}
+
+//================================ Swapping ===========================
+
+// Swapped-out images live in a memory-mapped file made of blocks the size of
+// a memory word. An image is its words followed by the text of any words whose
+// value is on the heap; in the swap copy those words hold the text's offset.
+SwapPolicy swapPolicy = SWAP_OLDEST_BLOCKED;
+SwapStats swapStats;
+static char swapFileName[256] = DEFAULT_SWAP_FILE;
+static int swapFd = -1;
+static memoryWord* swapMap = NULL;
+static int swapCapacity = 0;    // blocks in the swap file
+static memoryExtent* swapExtents = NULL;
+static int swapExtentCount = 0;
+static int swapExtentCapacity = 0;
+
+static long long now_nanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Charge the simulated clock for moving 'words' to or from the swap file
+static void swap_charge(int words) {
+    int cycles = (words + SWAP_WORDS_PER_CYCLE - 1) / SWAP_WORDS_PER_CYCLE;
+    currentTime += cycles;
+    swapStats.cycles += cycles;
+}
+
+// Grow the swap file so that at least 'blocks' more blocks are free
+static bool swap_grow(int blocks) {
+    if (swapFd == -1) {
+        swapFd = open(swapFileName, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (swapFd == -1) {
+            printf("Error: Cannot open swap file %s\n", swapFileName);
+            return false;
+        }
+        unlink(swapFileName);  // the file goes away when it is closed
+    }
+
+    int newCapacity = swapCapacity ? swapCapacity * 2 : memorySize;
+    if (newCapacity < swapCapacity + blocks) newCapacity = swapCapacity + blocks;
+    if (ftruncate(swapFd, (off_t)newCapacity * sizeof(memoryWord)) != 0) {
+        printf("Error: Cannot grow swap file to %d blocks\n", newCapacity);
+        return false;
+    }
+    // Map the larger file before letting go of the old view, so a failure
+    // leaves every swapped-out image where it was
+    memoryWord* grown = (memoryWord*)mmap(NULL, (size_t)newCapacity * sizeof(memoryWord),
+                                          PROT_READ | PROT_WRITE, MAP_SHARED, swapFd, 0);
+    if (grown == MAP_FAILED) {
+        printf("Error: Cannot map swap file\n");
+        return false;
+    }
+    if (swapMap != NULL) {
+        munmap(swapMap, (size_t)swapCapacity * sizeof(memoryWord));
+    }
+    swapMap = grown;
+    extent_insert(&swapExtents, &swapExtentCount, &swapExtentCapacity, swapCapacity, newCapacity - swapCapacity);
+    swapCapacity = newCapacity;
+    return true;
+}
+
+// Close the swap file and forget every swapped-out image
+void swapReset() {
+    if (swapMap != NULL) {
+        munmap(swapMap, (size_t)swapCapacity * sizeof(memoryWord));
+        swapMap = NULL;
+    }
+    if (swapFd != -1) {
+        close(swapFd);
+        swapFd = -1;
+    }
+    swapCapacity = 0;
+    swapExtentCount = 0;
+    memset(&swapStats, 0, sizeof(swapStats));
+}
+
+// Pick the resident process to swap out according to swapPolicy
+static PCB* swap_choose_victim(PCB* keep) {
+    PCB* best = NULL;
+    bool bestBlocked = false;
+    int bestLevel = 0;
+    for (int i = 0; i < numProcesses; i++) {
+        PCB* pcb = processTable[i].pcb;
+        if (pcb == NULL || pcb == keep || pcb == currentRunningProcess || pcb == pending_input_process) continue;
+        if (!pcb->resident || processTable[i].isComplete) continue;
+
+        bool blocked = strcmp(pcb->processState, "BLOCKED") == 0;
+        int level = processTable[i].currentQueueLevel;
+        // On a full tie the later arrival wins, as it is the last to be dispatched
+        bool better = true;
+        if (best != NULL && swapPolicy == SWAP_OLDEST_BLOCKED) {
+            if (blocked != bestBlocked) better = blocked;
+            else if (blocked && pcb->blockedSince != best->blockedSince) better = pcb->blockedSince < best->blockedSince;
+            else if (level != bestLevel) better = level > bestLevel;
+        } else if (best != NULL) {
+            if (level != bestLevel) better = level > bestLevel;
+            else if (blocked != bestBlocked) better = blocked;
+            else if (blocked && pcb->blockedSince != best->blockedSince) better = pcb->blockedSince < best->blockedSince;
+        }
+        if (better) {
+            best = pcb;
+            bestBlocked = blocked;
+            bestLevel = level;
+        }
+    }
+    return best;
+}
+
+// Bytes a string word takes in the swap image, terminator included
+static size_t swap_text_bytes(int index) {
+    if (memory[index].kind == WORD_ROPE) return memory[index].value.rope->length + 1;
+    return strlen(memory[index].value.heap) + 1;
+}
+
+// Copy a resident process image to the swap file and free its memory
+bool memorySwapOut(PCB* pcb) {
+    int pid = pcb->processID;
+    if (!pcb->resident) {
+        return false;
+    }
+    long long started = now_nanos();
+    memorySyncPCB(pcb);
+
+    // Shared text stays resident for its other users; only private words move
+    int words = pcbImageWords(pcb);
+    int first = pcb->text ? pcb->text->length : 0;
+    size_t textBytes = 0;
+    for (int k = first; k < words; k++) {
+        if (!pcbPageLoaded(pcb, k)) continue;
+        int i = pcbAddress(pcb, k);
+        if (memory[i].kind == WORD_HEAP || memory[i].kind == WORD_ROPE) textBytes += swap_text_bytes(i);
+    }
+    int blocks = words - first + (int)((textBytes + sizeof(memoryWord) - 1) / sizeof(memoryWord));
+
+    int slot = extent_take(swapExtents, &swapExtentCount, blocks);
+    if (slot == -1 && swap_grow(blocks)) {
+        slot = extent_take(swapExtents, &swapExtentCount, blocks);
+    }
+    if (slot == -1) {
+        printf("Error: No swap space for process %d\n", pid);
+        return false;
+    }
+
+    memoryWord* image = swapMap + slot;
+    char* text = (char*)(image + words - first);
+    size_t offset = 0;
+    for (int k = first; k < words; k++) {
+        if (!pcbPageLoaded(pcb, k)) {
+            // Instruction page that was never loaded or was evicted
+            memset(&image[k - first], 0, sizeof(memoryWord));
+            image[k - first].processID = -1;
+            continue;
+        }
+        int i = pcbAddress(pcb, k);
+        image[k - first] = memory[i];
+        // Ropes are written out chunk by chunk and come back as one string
+        if (memory[i].kind == WORD_HEAP || memory[i].kind == WORD_ROPE) {
+            size_t length = swap_text_bytes(i);
+            if (memory[i].kind == WORD_ROPE) {
+                rope_copy(memory[i].value.rope, text + offset);
+            } else {
+                memcpy(text + offset, memory[i].value.heap, length);
+            }
+            image[k - first].kind = WORD_HEAP;
+            image[k - first].value.number = (int64_t)offset;
+            offset += length;
+        }
+    }
+    memoryFreeImage(pcb);
+
+    pcb->resident = false;
+    pcb->swapStart = slot;
+    pcb->swapBlocks = blocks;
+    pcb->swapWords = words;
+
+    swapStats.swapOuts++;
+    swapStats.bytesOut += (long long)blocks * sizeof(memoryWord);
+    swapStats.swapOutNanos += now_nanos() - started;
+    swap_charge(words - first);
+    printf("Swapped out process %d (%d words)\n", pid, words - first);
+    return true;
+}
+
+// Bring a swapped-out process image back into memory
+bool memorySwapIn(PCB* pcb) {
+    if (pcb->resident) {
+        return true;
+    }
+    int pid = pcb->processID;
+    int words = pcb->swapWords;
+    if (!memoryAllocateImage(pcb, words)) {
+        printf("Error: Cannot make room to swap in process %d\n", pid);
+        return false;
+    }
+    long long started = now_nanos();
+
+    int first = pcb->text ? pcb->text->length : 0;
+    memoryWord* image = swapMap + pcb->swapStart;
+    const char* text = (const char*)(image + words - first);
+    for (int k = first; k < words; k++) {
+        if (!pcbPageLoaded(pcb, k)) continue;  // instruction pages fault back in
+        memoryWord* word = &memory[pcbAddress(pcb, k)];
+        *word = image[k - first];
+        if (image[k - first].kind == WORD_HEAP) {
+            word->value.heap = strdup(text + image[k - first].value.number);
+        }
+    }
+    extent_insert(&swapExtents, &swapExtentCount, &swapExtentCapacity, pcb->swapStart, pcb->swapBlocks);
+
+    // The image may come back at a different address
+    memoryWriteInt(pcbAddress(pcb, words - 2), pid, NAME_LOWER_MEMORY_BOUND, pcb->lowerMemoryBound);
+    memoryWriteInt(pcbAddress(pcb, words - 1), pid, NAME_UPPER_MEMORY_BOUND, pcb->upperMemoryBound);
+    pcb->resident = true;
+    memorySyncPCB(pcb);
+
+    swapStats.swapIns++;
+    swapStats.bytesIn += (long long)pcb->swapBlocks * sizeof(memoryWord);
+    swapStats.swapInNanos += now_nanos() - started;
+    swap_charge(words - first);
+    if (pagedMemory) {
+        printf("Swapped in process %d (%d pages resident)\n", pid, pcb->residentPages);
+    } else {
+        printf("Swapped in process %d at memory word %d\n", pid, pcb->lowerMemoryBound);
+    }
+    return true;
+}
+
+// Drop the swapped-out image of a process that finished without running again
+void memorySwapDiscard(PCB* pcb) {
+    if (pcb->resident) {
+        return;
+    }
+    extent_insert(&swapExtents, &swapExtentCount, &swapExtentCapacity, pcb->swapStart, pcb->swapBlocks);
+    pcb->swapBlocks = 0;
+    pcb->resident = true;
+}
+
+// Make 'words' contiguous words free, swapping out other processes and
+// compacting as needed. 'keep' (may be NULL) is never swapped out.
+bool memoryMakeRoom(int words, PCB* keep) {
+    int limit = memorySize;
+    if (pagedMemory) {
+        words = ((words + pageSize - 1) >> pageShift) << pageShift;  // whole frames
+        limit = frameCount << pageShift;
+    } else if (placementPolicy == PLACE_BUDDY) {
+        words = placement_size(words);
+        limit = 1 << (buddy_order(memorySize + 1) - 1);  // largest aligned block
+    }
+    if (words > limit) {
+        return false;
+    }
+    while (memoryFreeWords + (evictableFrames << pageShift) < words) {
+        PCB* victim = swapPolicy == SWAP_NONE ? NULL : swap_choose_victim(keep);
+        if (victim == NULL || !memorySwapOut(victim)) {
+            return false;
+        }
+    }
+    if (pagedMemory) {
+        return true;
+    }
+
+    // Buddy blocks cannot be compacted, so swap out until one is big enough
+    while (placementPolicy == PLACE_BUDDY && memoryLargestFreeBlock() < words) {
+        PCB* victim = swapPolicy == SWAP_NONE ? NULL : swap_choose_victim(keep);
+        if (victim == NULL || !memorySwapOut(victim)) {
+            return false;
+        }
+    }
+    if (memoryLargestFreeBlock() >= words) {
+        return true;
+    }
+
+    // Enough words are free but not in one piece
+    int cycles = memoryCompact();
+    currentTime += cycles;
+    char message[100];
+    snprintf(message, sizeof(message), "Memory compacted, clock advanced %d cycles\n", cycles);
+    log_message(gui, message);
+    return true;
+}
+
+//================================ Variables ===========================
+
+static void value_release(Value* value) {
+    if (value->kind == VALUE_SHARED && --value->data.shared->refCount == 0) {
+        free(value->data.shared);
+    } else if (value->kind == VALUE_ROPE) {
+        ropeRelease(value->data.rope);
+    }
+    value->kind = VALUE_NONE;
+}
+
+static void value_set_int(Value* value, int64_t number) {
+    value_release(value);
+    value->data.number = number;
+    value->kind = VALUE_INT;
+}
+
+// Set from text: canonical integers become numbers, short strings are inline
+static bool value_set_text(Value* value, const char* text) {
+    long long number;
+    if (canonical_integer(text, &number)) {
+        value_set_int(value, number);
+        return true;
+    }
+    size_t length = strlen(text);
+    if (length < VALUE_INLINE_SIZE) {
+        value_release(value);
+        memcpy(value->data.text, text, length + 1);
+        value->kind = VALUE_INLINE;
+        return true;
+    }
+    SharedString* shared = (SharedString*)malloc(sizeof(SharedString) + length + 1);
+    if (!shared) {
+        return false;
+    }
+    shared->refCount = 1;
+    shared->length = length;
+    memcpy(shared->text, text, length + 1);
+    value_release(value);
+    value->data.shared = shared;
+    value->kind = VALUE_SHARED;
+    return true;
+}
+
+// Take over a rope reference; short contents are kept as plain text
+static bool value_set_rope(Value* value, Rope* rope) {
+    if (rope->length < VALUE_INLINE_SIZE) {
+        bool ok = value_set_text(value, ropeText(rope));
+        ropeRelease(rope);
+        return ok;
+    }
+    value_release(value);
+    value->data.rope = rope;
+    value->kind = VALUE_ROPE;
+    return true;
+}
+
+static void value_copy(Value* to, const Value* from) {
+    if (to == from) return;
+    if (from->kind == VALUE_SHARED) {
+        from->data.shared->refCount++;
+    } else if (from->kind == VALUE_ROPE) {
+        ropeRetain(from->data.rope);
+    }
+    value_release(to);
+    *to = *from;
+}
+
+// Text of a value; numbers are formatted into 'buffer'. NULL if the value
+// is a rope there was no memory to flatten.
+static const char* value_text(const Value* value, char* buffer, size_t size) {
+    switch (value->kind) {
+        case VALUE_INT:
+            snprintf(buffer, size, "%lld", (long long)value->data.number);
+            return buffer;
+        case VALUE_INLINE: return value->data.text;
+        case VALUE_SHARED: return value->data.shared->text;
+        case VALUE_ROPE: return ropeText(value->data.rope);
+        default: return "";
+    }
+}
+
+// Integer a value stands for, with the same rules as atoi on its text
+static bool value_number(const Value* value, long long* number) {
+    if (value->kind == VALUE_INT) {
+        *number = value->data.number;
+        return true;
+    }
+    char buffer[24];
+    const char* text = value_text(value, buffer, sizeof(buffer));
+    if (value->kind == VALUE_NONE || text == NULL || !isNumeric(text)) {
+        return false;
+    }
+    *number = atoi(text);
+    return true;
+}
+
+static unsigned int variable_hash(int nameID, int hashSize) {
+    return ((unsigned int)nameID * 2654435761u) & (hashSize - 1);
+}
+
+static bool variable_scope_rehash(VariableScope* scope, int hashSize) {
+    uint16_t* hash = (uint16_t*)calloc(hashSize, sizeof(uint16_t));
+    if (!hash) {
+        return false;
+    }
+    for (int slot = 0; slot < scope->count; slot++) {
+        unsigned int h = variable_hash(scope->slots[slot].nameID, hashSize);
+        while (hash[h] != 0) h = (h + 1) & (hashSize - 1);
+        hash[h] = (uint16_t)(slot + 1);
+    }
+    free(scope->hash);
+    scope->hash = hash;
+    scope->hashSize = hashSize;
+    return true;
+}
+
+// Return the slot holding 'nameID', optionally adding it (-1 if absent or out of memory)
+int variableScopeSlot(VariableScope* scope, int nameID, bool create) {
+    if (scope->hashSize > 0) {
+        unsigned int h = variable_hash(nameID, scope->hashSize);
+        while (scope->hash[h] != 0) {
+            int slot = scope->hash[h] - 1;
+            if (scope->slots[slot].nameID == nameID) {
+                return slot;
+            }
+            h = (h + 1) & (scope->hashSize - 1);
+        }
+    }
+    if (!create || nameID == NAME_NONE || scope->count >= UINT16_MAX - 1) {
+        return -1;
+    }
+    if (scope->count == scope->capacity) {
+        int capacity = scope->capacity ? scope->capacity * 2 : 4;
+        Variable* grown = (Variable*)realloc(scope->slots, capacity * sizeof(Variable));
+        if (!grown) return -1;
+        scope->slots = grown;
+        scope->capacity = capacity;
+    }
+    // Keep the hash at most half full
+    if ((scope->count + 1) * 2 > scope->hashSize &&
+        !variable_scope_rehash(scope, scope->hashSize ? scope->hashSize * 2 : 8)) {
+        return -1;
+    }
+    int slot = scope->count++;
+    Variable* var = &scope->slots[slot];
+    var->nameID = (uint16_t)nameID;
+    var->value.kind = VALUE_NONE;
+    unsigned int h = variable_hash(nameID, scope->hashSize);
+    while (scope->hash[h] != 0) h = (h + 1) & (scope->hashSize - 1);
+    scope->hash[h] = (uint16_t)(slot + 1);
+    return slot;
+}
+
+// Start a scope with a program's names in the slots its code was decoded against
+bool variableScopeInit(VariableScope* scope, const uint16_t* names, int count) {
+    memset(scope, 0, sizeof(*scope));
+    for (int i = 0; i < count; i++) {
+        if (variableScopeSlot(scope, names[i], true) != i) {
+            variableScopeFree(scope);
+            return false;
+        }
+    }
+    return true;
+}
+
+void variableScopeFree(VariableScope* scope) {
+    for (int i = 0; i < scope->count; i++) {
+        value_release(&scope->slots[i].value);
+    }
+    free(scope->slots);
+    free(scope->hash);
+    memset(scope, 0, sizeof(*scope));
+}
+
+//================================ Write-Behind ===========================
+
+// By default writeFile goes straight to the host and reports any failure.
+// With --write-behind-bytes=N its output is held here instead and reaches the
+// host in batches: when the buffered bytes or the oldest pending write cross
+// a threshold, before any file is read back, and on shutdown. "w" truncates,
+// so a second write to a pending file simply replaces its contents. Errors
+// found at flush time are counted and logged, the instruction has moved on.
+size_t writeBehindBytes = 0;             // 0 writes through
+int writeBehindAge = 8;                  // time units a write may stay pending
+bool syncWrites = false;                 // fsync each batch
+
+static PendingWrite pendingWrites[WRITE_BEHIND_FILES];
+static int pendingWriteCount = 0;
+static size_t pendingWriteBytes = 0;
+
+static size_t value_length(const Value* value) {
+    char buffer[24];
+    switch (value->kind) {
+        case VALUE_SHARED: return value->data.shared->length;
+        case VALUE_ROPE: return value->data.rope->length;
+        default: return strlen(value_text(value, buffer, sizeof(buffer)));
+    }
+}
+
+static void write_failed(const char* path, const char* what) {
+    char message[300];
+    snprintf(message, sizeof(message), "Error: %s of '%s' failed", what, path);
+    printf("%s\n", message);
+    log_message(gui, message);
+    fileIOStats.writeErrors++;
+}
+
+// Write the whole value to the host file and flush it; the file is left open
+// for close_host_file. NULL if any part of it did not make it out.
+static FILE* write_host_file(const char* path, const Value* content) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        write_failed(path, "Open");
+        return NULL;
+    }
+    char buffer[24];
+    bool written = content->kind == VALUE_ROPE
+                   ? ropeWrite(content->data.rope, file)   // chunk by chunk, never flattened
+                   : fputs(value_text(content, buffer, sizeof(buffer)), file) != EOF;
+    if (!written || fflush(file) != 0) {
+        write_failed(path, "Write");
+        fclose(file);
+        return NULL;
+    }
+    fileIOStats.bytesWritten += (long long)value_length(content);
+    return file;
+}
+
+static bool close_host_file(FILE* file, const char* path) {
+    bool synced = true;
+    if (syncWrites) {
+        synced = fsync(fileno(file)) == 0;
+        if (synced) {
+            fileIOStats.fsyncs++;
+        } else {
+            write_failed(path, "Fsync");
+        }
+    }
+    if (fclose(file) != 0) {
+        write_failed(path, "Close");
+        return false;
+    }
+    return synced;
+}
+
+// True if every pending write reached the host
+bool writeBehindFlush() {
+    if (pendingWriteCount == 0) {
+        return true;
+    }
+    FILE* written[WRITE_BEHIND_FILES];
+    bool ok = true;
+
+    for (int i = 0; i < pendingWriteCount; i++) {
+        written[i] = write_host_file(pendingWrites[i].path, &pendingWrites[i].content);
+        ok = ok && written[i] != NULL;
+        value_release(&pendingWrites[i].content);
+    }
+
+    // Sync once per file per batch, after every write has been issued
+    for (int i = 0; i < pendingWriteCount; i++) {
+        if (written[i] != NULL) {
+            ok = close_host_file(written[i], pendingWrites[i].path) && ok;
+        }
+        free(pendingWrites[i].path);
+    }
+    fileIOStats.writeBatches++;
+    pendingWriteCount = 0;
+    pendingWriteBytes = 0;
+    return ok;
+}
+
+// Flush once the oldest pending write has waited long enough
+void writeBehindTick() {
+    if (pendingWriteCount > 0 && currentTime - pendingWrites[0].queuedAt >= writeBehindAge) {
+        writeBehindFlush();
+    }
+}
+
+static bool write_behind_queue(const char* path, const Value* content) {
+    if (writeBehindBytes == 0) {
+        FILE* file = write_host_file(path, content);
+        return file != NULL && close_host_file(file, path);
+    }
+    PendingWrite* pending = NULL;
+    for (int i = 0; i < pendingWriteCount; i++) {
+        if (strcmp(pendingWrites[i].path, path) == 0) {
+            pending = &pendingWrites[i];
+            pendingWriteBytes -= value_length(&pending->content);
+            fileIOStats.writesCoalesced++;
+            break;
+        }
+    }
+    if (pending == NULL) {
+        if (pendingWriteCount == WRITE_BEHIND_FILES) {
+            writeBehindFlush();
+        }
+        char* copy = strdup(path);
+        if (!copy) {
+            return false;
+        }
+        pending = &pendingWrites[pendingWriteCount++];
+        pending->path = copy;
+        pending->content.kind = VALUE_NONE;
+        pending->queuedAt = currentTime;
+    }
+    value_copy(&pending->content, content);
+    pendingWriteBytes += value_length(content);
+
+    if (pendingWriteBytes >= writeBehindBytes) {
+        writeBehindFlush();
+    }
+    return true;
+}
+
+//================================ Simulated File System ===========================
+
+// With --simulated-fs, writeFile, readFile and "assign x readFile" work on
+// files kept in RAM: an inode table, a hashed directory and a pool of
+// FS_BLOCK_SIZE blocks. --simulated-fs=DIR loads DIR's files at start and
+// writes them back when the simulation completes.
+bool simulatedFS = false;
+static char fsDirectory[256] = "";
+static bool fsDirty = false;          // changed since the last import or export
+
+static SimInode* fsInodes = NULL;
+static int fsInodeCount = 0;
+static int fsInodeCapacity = 0;
+static int* fsDirectoryHash = NULL;   // inode number + 1, 0 when empty
+static int fsHashSize = 0;
+static char* fsBlocks = NULL;
+static int fsBlockCount = 0;
+static int fsBlockCapacity = 0;
+static int* fsFreeBlocks = NULL;
+static int fsFreeBlockCount = 0;
+
+static unsigned int fs_hash(const char* name) {
+    unsigned int hash = 2166136261u;
+    for (; *name; name++) {
+        hash = (hash ^ (unsigned char)*name) * 16777619u;
+    }
+    return hash;
+}
+
+static bool fs_rehash(int hashSize) {
+    int* hash = (int*)calloc(hashSize, sizeof(int));
+    if (!hash) {
+        return false;
+    }
+    for (int inode = 0; inode < fsInodeCount; inode++) {
+        unsigned int i = fs_hash(fsInodes[inode].name) & (hashSize - 1);
+        while (hash[i] != 0) i = (i + 1) & (hashSize - 1);
+        hash[i] = inode + 1;
+    }
+    free(fsDirectoryHash);
+    fsDirectoryHash = hash;
+    fsHashSize = hashSize;
+    return true;
+}
+
+// Inode number for a name, creating an empty file if asked (-1 if none)
+static int fs_lookup(const char* name, bool create) {
+    if (fsHashSize > 0) {
+        unsigned int i = fs_hash(name) & (fsHashSize - 1);
+        for (; fsDirectoryHash[i] != 0; i = (i + 1) & (fsHashSize - 1)) {
+            if (strcmp(fsInodes[fsDirectoryHash[i] - 1].name, name) == 0) {
+                return fsDirectoryHash[i] - 1;
+            }
+        }
+    }
+    if (!create) {
+        return -1;
+    }
+    // Keep the directory at most half full
+    if ((fsInodeCount + 1) * 2 > fsHashSize && !fs_rehash(fsHashSize ? fsHashSize * 2 : 64)) {
+        return -1;
+    }
+    if (fsInodeCount == fsInodeCapacity) {
+        int capacity = fsInodeCapacity ? fsInodeCapacity * 2 : 32;
+        SimInode* grown = (SimInode*)realloc(fsInodes, capacity * sizeof(SimInode));
+        if (!grown) {
+            return -1;
+        }
+        fsInodes = grown;
+        fsInodeCapacity = capacity;
+    }
+    char* copy = strdup(name);
+    if (!copy) {
+        return -1;
+    }
+    int inode = fsInodeCount++;
+    fsInodes[inode] = (SimInode){ copy, 0, NULL, 0, 0 };
+    unsigned int i = fs_hash(name) & (fsHashSize - 1);
+    while (fsDirectoryHash[i] != 0) i = (i + 1) & (fsHashSize - 1);
+    fsDirectoryHash[i] = inode + 1;
+    return inode;
+}
+
+static int fs_block_alloc() {
+    if (fsFreeBlockCount > 0) {
+        return fsFreeBlocks[--fsFreeBlockCount];
+    }
+    if (fsBlockCount == fsBlockCapacity) {
+        int capacity = fsBlockCapacity ? fsBlockCapacity * 2 : 64;
+        char* grown = (char*)realloc(fsBlocks, (size_t)capacity * FS_BLOCK_SIZE);
+        if (!grown) {
+            return -1;
+        }
+        int* freeList = (int*)realloc(fsFreeBlocks, capacity * sizeof(int));
+        if (!freeList) {
+            fsBlocks = grown;
+            return -1;
+        }
+        fsBlocks = grown;
+        fsFreeBlocks = freeList;
+        fsBlockCapacity = capacity;
+    }
+    return fsBlockCount++;
+}
+
+static void fs_truncate(SimInode* file) {
+    for (int i = 0; i < file->blockCount; i++) {
+        fsFreeBlocks[fsFreeBlockCount++] = file->blocks[i];
+    }
+    file->blockCount = 0;
+    file->length = 0;
+}
+
+static bool fs_append(int inode, const char* data, size_t length) {
+    while (length > 0) {
+        SimInode* file = &fsInodes[inode];
+        size_t used = file->length % FS_BLOCK_SIZE;
+        if (file->length == (size_t)file->blockCount * FS_BLOCK_SIZE) {   // last block full
+            if (file->blockCount == file->blockCapacity) {
+                int capacity = file->blockCapacity ? file->blockCapacity * 2 : 4;
+                int* grown = (int*)realloc(file->blocks, capacity * sizeof(int));
+                if (!grown) {
+                    return false;
+                }
+                file->blocks = grown;
+                file->blockCapacity = capacity;
+            }
+            int block = fs_block_alloc();
+            if (block < 0) {
+                return false;
+            }
+            file->blocks[file->blockCount++] = block;
+        }
+        size_t room = FS_BLOCK_SIZE - used;
+        size_t n = length < room ? length : room;
+        memcpy(fsBlocks + (size_t)file->blocks[file->blockCount - 1] * FS_BLOCK_SIZE + used, data, n);
+        file->length += n;
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+// Replace a file's contents with a value, creating the file if needed
+static bool fs_write(const char* name, const Value* content) {
+    int inode = fs_lookup(name, true);
+    if (inode < 0) {
+        return false;
+    }
+    fsDirty = true;
+    fs_truncate(&fsInodes[inode]);
+    if (content->kind != VALUE_ROPE) {
+        char buffer[24];
+        const char* text = value_text(content, buffer, sizeof(buffer));
+        return fs_append(inode, text, strlen(text));
+    }
+    const Rope* rope = content->data.rope;
+    size_t offset = 0;
+    for (int i = 0; i < rope->chunkCount; i++) {
+        size_t length = i + 1 < rope->chunkCount ? ROPE_CHUNK_SIZE : rope->length - offset;
+        if (!fs_append(inode, rope->chunks[i], length)) {
+            return false;
+        }
+        offset += length;
+    }
+    return true;
+}
+
+// A file's contents as a rope, laid out as ropeReadFile would (NULL if missing)
+static Rope* fs_read(const char* name) {
+    int inode = fs_lookup(name, false);
+    if (inode < 0) {
+        return NULL;
+    }
+    const SimInode* file = &fsInodes[inode];
+    Rope* rope = rope_new();
+    int chunkCount = (int)(file->length / ROPE_CHUNK_SIZE) + 1;
+    if (rope == NULL || (rope->chunks = (char**)calloc(chunkCount, sizeof(char*))) == NULL) {
+        ropeRelease(rope);
+        return NULL;
+    }
+    const int blocksPerChunk = ROPE_CHUNK_SIZE / FS_BLOCK_SIZE;
+    for (int c = 0; c < chunkCount; c++) {
+        size_t length = c + 1 < chunkCount ? ROPE_CHUNK_SIZE : file->length - (size_t)c * ROPE_CHUNK_SIZE;
+        char* chunk = (char*)malloc(ROPE_CHUNK_SIZE + 1);
+        if (chunk == NULL) {
+            ropeRelease(rope);
+            return NULL;
+        }
+        for (size_t copied = 0; copied < length; copied += FS_BLOCK_SIZE) {
+            int block = file->blocks[c * blocksPerChunk + copied / FS_BLOCK_SIZE];
+            size_t n = length - copied < FS_BLOCK_SIZE ? length - copied : FS_BLOCK_SIZE;
+            memcpy(chunk + copied, fsBlocks + (size_t)block * FS_BLOCK_SIZE, n);
+        }
+        chunk[length] = '\0';
+        rope->chunks[rope->chunkCount++] = chunk;
+        rope->length += length;
     }
+    return rope;
 }
+
+// Load every regular file of a real directory; it is written back by fileSystemExport
+void fileSystemImport(const char* directory) {
+    simulatedFS = true;
+    snprintf(fsDirectory, sizeof(fsDirectory), "%s", directory);
+    DIR* dir = opendir(directory);
+    if (dir == NULL) {
+        printf("Error: Cannot open directory '%s' for the simulated file system\n", directory);
+        return;
+    }
+    int imported = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        char path[512];
+        struct stat info;
+        snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+        if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)) continue;
+        FILE* file = fopen(path, "r");
+        Rope* contents = file ? ropeReadFile(file) : NULL;
+        if (file) fclose(file);
+        Value value = { .kind = VALUE_ROPE, .data.rope = contents };
+        if (contents == NULL || !fs_write(entry->d_name, &value)) {
+            printf("Error: Cannot import '%s' into the simulated file system\n", path);
+        } else {
+            imported++;
+        }
+        ropeRelease(contents);
+    }
+    closedir(dir);
+    fsDirty = false;   // the directory already holds these files
+    printf("Simulated file system: imported %d files from '%s'\n", imported, directory);
 }
 
-// Read program file
-int readProgramFile(const char* fileName, char*** instructions) {
-    
-    FILE* file = fopen(fileName, "r");
-    if (!file) {
-        printf("Failed to open file: %s\n", fileName);
+// Create the directories above 'path' that do not exist yet
+static bool make_parent_directories(const char* path) {
+    char directory[512];
+    snprintf(directory, sizeof(directory), "%s", path);
+    for (char* slash = strchr(directory + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        *slash = '/';
+    }
+    return true;
+}
+
+// Write every simulated file back to the directory it was imported from,
+// once per batch of changes. Failures are reported like writeBehindFlush's.
+void fileSystemExport() {
+    if (!simulatedFS || fsDirectory[0] == '\0' || !fsDirty) {
+        return;
+    }
+    for (int inode = 0; inode < fsInodeCount; inode++) {
+        const SimInode* file = &fsInodes[inode];
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", fsDirectory, file->name);
+        if (!make_parent_directories(path)) {
+            write_failed(path, "Mkdir");
+            continue;
+        }
+        FILE* out = fopen(path, "w");
+        if (out == NULL) {
+            write_failed(path, "Open");
+            continue;
+        }
+        bool written = true;
+        for (int i = 0; i < file->blockCount && written; i++) {
+            size_t length = i + 1 < file->blockCount ? FS_BLOCK_SIZE : file->length - (size_t)i * FS_BLOCK_SIZE;
+            written = fwrite(fsBlocks + (size_t)file->blocks[i] * FS_BLOCK_SIZE, 1, length, out) == length;
+        }
+        if (!written) {
+            write_failed(path, "Write");
+        }
+        if (fclose(out) != 0 && written) {
+            write_failed(path, "Close");
+        }
+    }
+    fsDirty = false;
+}
+
+void fileSystemClear() {
+    for (int inode = 0; inode < fsInodeCount; inode++) {
+        free(fsInodes[inode].name);
+        free(fsInodes[inode].blocks);
+    }
+    free(fsInodes);
+    free(fsDirectoryHash);
+    free(fsBlocks);
+    free(fsFreeBlocks);
+    fsInodes = NULL;
+    fsDirectoryHash = NULL;
+    fsBlocks = NULL;
+    fsFreeBlocks = NULL;
+    fsInodeCount = fsInodeCapacity = fsHashSize = 0;
+    fsBlockCount = fsBlockCapacity = fsFreeBlockCount = 0;
+    fsDirty = false;
+}
+
+//================================ Program Cache ===========================
+
+// Open-addressed table of parsed programs keyed by canonical path; the inode
+// and mtime decide whether an entry still matches the file
+static ProgramCacheEntry** programCache = NULL;
+static int programCacheSize = 0;
+static int programCacheCount = 0;
+static int programCacheNextID = 1;
+ProgramCacheStats programCacheStats;
+
+static ProgramCacheEntry** program_cache_slot(const char* path) {
+    unsigned int slot = hash_string(path) & (programCacheSize - 1);
+    while (programCache[slot] != NULL && strcmp(programCache[slot]->path, path) != 0) {
+        slot = (slot + 1) & (programCacheSize - 1);
+    }
+    return &programCache[slot];
+}
+
+// Keep the table at most half full
+static bool program_cache_reserve() {
+    if ((programCacheCount + 1) * 2 <= programCacheSize) {
+        return true;
+    }
+    int oldSize = programCacheSize;
+    ProgramCacheEntry** old = programCache;
+    int newSize = oldSize ? oldSize * 2 : 16;
+    programCache = (ProgramCacheEntry**)calloc(newSize, sizeof(ProgramCacheEntry*));
+    if (!programCache) {
+        programCache = old;
+        return false;
+    }
+    programCacheSize = newSize;
+    for (int i = 0; i < oldSize; i++) {
+        if (old[i] != NULL) *program_cache_slot(old[i]->path) = old[i];
+    }
+    free(old);
+    return true;
+}
+
+static void program_cache_free_entry(ProgramCacheEntry* entry) {
+    free(entry->path);
+    free(entry->text);
+    free(entry->offsets);
+    free(entry->code);
+    free(entry->operands);
+    free(entry->symbols);
+    free(entry);
+}
+
+// Append an operand string to a program's operand pool and return its offset
+static uint32_t operand_add(char** pool, size_t* size, size_t* capacity, const char* operand) {
+    size_t length = strlen(operand) + 1;
+    if (*size + length > *capacity) {
+        size_t newCapacity = *capacity ? *capacity * 2 : 256;
+        while (newCapacity < *size + length) newCapacity *= 2;
+        char* grown = (char*)realloc(*pool, newCapacity);
+        if (!grown) {
+            return 0;  // offset 0 is always the empty string
+        }
+        *pool = grown;
+        *capacity = newCapacity;
+    }
+    uint32_t offset = (uint32_t)*size;
+    memcpy(*pool + offset, operand, length);
+    *size += length;
+    return offset;
+}
+
+static Mutex* mutex_by_name(const char* name) {
+    if (strcmp(name, "file") == 0) return &fileMutex;
+    if (strcmp(name, "userInput") == 0) return &inputMutex;
+    if (strcmp(name, "userOutput") == 0) return &outputMutex;
+    return NULL;
+}
+
+// Bind a name to its slot in the program's variable scope
+static int16_t decode_symbol(const char* name, ProgramSymbols* symbols) {
+    if (symbols == NULL) {
         return -1;
     }
+    int slot = variableScopeSlot(&symbols->names, intern_name(name), true);
+    return slot >= 0 && slot <= INT16_MAX ? (int16_t)slot : -1;
+}
 
-    // Count lines first
-    int IC = 0;
-    char buffer[256];
-    while (fgets(buffer, sizeof(buffer), file)) {
-        if (buffer[0] != '\n' && buffer[0] != '#') IC++;
+// Bind a read operand to a name the program has already assigned; literals,
+// file names and anything else keep looking up by name, and none of them
+// are interned
+static int16_t decode_variable(const char* name, ProgramSymbols* symbols) {
+    if (symbols == NULL || isNumeric(name) || name[0] == '"') {
+        return -1;
     }
-    
-    rewind(file);
-    
-    // Allocate instruction array
-    *instructions = (char**)malloc(IC * sizeof(char*));
-    if (!*instructions) {
-        printf("Memory allocation failed\n");
-        log_message(gui, "Memory allocation failed\n");
-        fclose(file);
+    int nameID = intern_lookup(name);
+    int slot = nameID < 0 ? -1 : variableScopeSlot(&symbols->names, nameID, false);
+    return slot >= 0 && slot <= INT16_MAX ? (int16_t)slot : -1;
+}
+
+// Pick the process variable word an assignment will use: words are handed
+// out in the order names are first assigned, as memoryStoreVariable would
+static int8_t decode_local(int16_t var, ProgramSymbols* symbols) {
+    if (var < 0) {
         return -1;
     }
-    
-    // Read instructions
-    int index = 0;
-    while (fgets(buffer, sizeof(buffer), file)) {
-        if (buffer[0] == '\n' || buffer[0] == '#') continue;
-        
-        buffer[strcspn(buffer, "\n")] = 0; // Remove newline
-        (*instructions)[index] = strdup(buffer);
-        index++;
+    for (int i = 0; i < symbols->assignedCount; i++) {
+        if (symbols->assigned[i] == var) return (int8_t)i;
     }
-    
-    fclose(file);
-    return IC;
+    if (symbols->assignedCount >= PROCESS_VARIABLE_WORDS) {
+        return -1;
+    }
+    symbols->assigned[symbols->assignedCount] = var;
+    return (int8_t)symbols->assignedCount++;
 }
 
-// Allocate memory for process
-int memoryAllocate(int processID, int IC) {
-    int firstFree = -1;
-    bool flag = false;
-    int placeNeeded = IC + 3 + 6;  // Instructions + var + PCB entries
-    for (int i = 0; i < 60; i++) {
-        if (memory[i].name == NULL) {
-            for(int j=i; j<placeNeeded+i && j<60; j++){
-                if(memory[j].name!=NULL){
-                    i=j;
-                    flag=false;
-                    break;
-                }
-                else 
-                    flag = true;
-            }    
+// Decode one program line, with the same operand rules execute() always used.
+// 'symbols' collects the program's names (NULL for a lone line, whose
+// operands are then looked up by name)
+static void decode_instruction(const char* line, Instruction* ins, ProgramSymbols* symbols,
+                               char** pool, size_t* size, size_t* capacity) {
+    char command[20] = "", arg1[100] = "", arg2[100] = "";
+    int numArgs = sscanf(line, "%19s %99s %99[^\n]", command, arg1, arg2);
+
+    ins->opcode = OP_INVALID;
+    ins->mutex = NULL;
+    ins->slot = -1;
+    ins->var1 = -1;
+    ins->var2 = -1;
+    ins->arg1 = 0;
+    ins->arg2 = 0;
+    if (strcmp(command, "print") == 0 && numArgs >= 2) {
+        ins->opcode = OP_PRINT;
+    } else if (strcmp(command, "assign") == 0 && numArgs == 3) {
+        if (strcmp(arg2, "input") == 0) {
+            ins->opcode = OP_ASSIGN_INPUT;
+        } else if (strncmp(arg2, "readFile", 8) == 0) {
+            char fileName[100] = "";
+            sscanf(arg2, "readFile %99s", fileName);
+            strcpy(arg2, fileName);
+            ins->opcode = OP_ASSIGN_READ_FILE;
+        } else {
+            long long number;
+            ins->opcode = OP_ASSIGN;
+            if (canonical_integer(arg2, &number)) {
+                ins->opcode = OP_ASSIGN_NUMBER;
+                ins->number = number;
+            }
         }
-        if (flag == true) {
-            firstFree = i;
+    } else if (strcmp(command, "printFromTo") == 0 && numArgs == 3) {
+        ins->opcode = OP_PRINT_FROM_TO;
+    } else if (strcmp(command, "writeFile") == 0 && numArgs == 3) {
+        ins->opcode = OP_WRITE_FILE;
+    } else if (strcmp(command, "readFile") == 0 && numArgs == 2) {
+        ins->opcode = OP_READ_FILE;
+    } else if (strcmp(command, "semWait") == 0 && numArgs == 2) {
+        ins->opcode = OP_SEM_WAIT;
+        ins->mutex = mutex_by_name(arg1);
+    } else if (strcmp(command, "semSignal") == 0 && numArgs == 2) {
+        ins->opcode = OP_SEM_SIGNAL;
+        ins->mutex = mutex_by_name(arg1);
+    }
+
+    if (ins->opcode == OP_INVALID) {
+        ins->arg1 = operand_add(pool, size, capacity, command);
+        return;
+    }
+    if (ins->opcode != OP_SEM_WAIT && ins->opcode != OP_SEM_SIGNAL) {
+        ins->arg1 = operand_add(pool, size, capacity, arg1);
+    }
+    if (numArgs == 3 && ins->opcode != OP_PRINT && ins->opcode != OP_ASSIGN_INPUT) {
+        ins->arg2 = operand_add(pool, size, capacity, arg2);
+    }
+
+    switch (ins->opcode) {
+        case OP_ASSIGN:
+        case OP_ASSIGN_NUMBER:
+        case OP_ASSIGN_READ_FILE:
+        case OP_ASSIGN_INPUT:
+            ins->var1 = decode_symbol(arg1, symbols);
+            ins->slot = decode_local(ins->var1, symbols);
+            if (ins->opcode == OP_ASSIGN_INPUT) {
+                ins->slot = -1;   // the input dialog stores by name
+            } else {
+                ins->var2 = decode_variable(arg2, symbols);
+            }
             break;
-        } 
-    } 
-    return firstFree;  // Return the first free memory location found
+        case OP_PRINT:
+        case OP_READ_FILE:
+            ins->var1 = decode_variable(arg1, symbols);
+            break;
+        case OP_PRINT_FROM_TO:
+        case OP_WRITE_FILE:
+            ins->var1 = decode_variable(arg1, symbols);
+            ins->var2 = decode_variable(arg2, symbols);
+            break;
+        default:
+            break;
+    }
 }
 
-// Free memory allocated for process
-void memorydeallocate(int processID) {
-    for (int i = 0; i < 60; i++) {
-        if (memory[i].processID == processID) {
-            if (memory[i].name != NULL) free(memory[i].name);
-            if (memory[i].value != NULL) free(memory[i].value);
-            memory[i].processID = -1;  
-            memory[i].name = NULL;
-            memory[i].value = NULL;
-            
-            printf("Freed memory word %d\n", i);
-            
+// Fuse semWait X; op; semSignal X into one superinstruction. The middle
+// instruction must not wait for the user, so sections around "assign x input"
+// stay apart; a body that blocks on the disk is handled when it runs.
+static void fuse_superinstructions(Instruction* code, int count) {
+    for (int i = 0; i + 2 < count; i++) {
+        Opcode body = (Opcode)code[i + 1].opcode;
+        if (code[i].opcode == OP_SEM_WAIT && code[i].mutex != NULL &&
+            code[i + 2].opcode == OP_SEM_SIGNAL && code[i + 2].mutex == code[i].mutex &&
+            body != OP_SEM_WAIT && body != OP_SEM_SIGNAL && body != OP_ASSIGN_INPUT) {
+            code[i].opcode = OP_CRITICAL_SECTION;
+            i += 2;
         }
     }
 }
 
-// Create a process
-PCB* createProcess(const char* fileName) {
-    char** instructions;
-    int IC = readProgramFile(fileName, &instructions);
-    
-    if (IC <= 0) {
-        printf("Failed to read program file or no instructions found\n");
+// Pack freshly read lines, and their decoded form, into a cache entry
+static ProgramCacheEntry* program_cache_build(char* path, const struct stat* info, char** lines, int count) {
+    ProgramCacheEntry* entry = (ProgramCacheEntry*)calloc(1, sizeof(ProgramCacheEntry));
+    if (!entry) return NULL;
+    for (int i = 0; i < count; i++) {
+        entry->textBytes += strlen(lines[i]) + 1;
+    }
+    entry->text = (char*)malloc(entry->textBytes);
+    entry->offsets = (size_t*)malloc(count * sizeof(size_t));
+    entry->code = (Instruction*)malloc(count * sizeof(Instruction));
+    size_t operandCapacity = 0;
+    ProgramSymbols symbols;
+    memset(&symbols, 0, sizeof(symbols));
+    operand_add(&entry->operands, &entry->operandBytes, &operandCapacity, "");
+    if (!entry->text || !entry->offsets || !entry->code || !entry->operands) {
+        entry->path = NULL;
+        program_cache_free_entry(entry);
         return NULL;
     }
-    
-    
-    int p = memoryAllocate(processCount, IC); // p is the first free memory location
-    
-    if (p == -1) {
-        printf("Not enough memory to allocate process\n");
-        // Free instructions
-        for (int i = 0; i < IC; i++) {
-            free(instructions[i]);
-        }
-        free(instructions);
+    size_t offset = 0;
+    for (int i = 0; i < count; i++) {
+        size_t length = strlen(lines[i]) + 1;
+        memcpy(entry->text + offset, lines[i], length);
+        entry->offsets[i] = offset;
+        offset += length;
+        decode_instruction(lines[i], &entry->code[i], &symbols, &entry->operands, &entry->operandBytes, &operandCapacity);
+    }
+    fuse_superinstructions(entry->code, count);
+    entry->symbolCount = symbols.names.count;
+    entry->symbols = (uint16_t*)malloc((entry->symbolCount + 1) * sizeof(uint16_t));
+    for (int i = 0; entry->symbols && i < entry->symbolCount; i++) {
+        entry->symbols[i] = symbols.names.slots[i].nameID;
+    }
+    variableScopeFree(&symbols.names);
+    if (!entry->symbols) {
+        entry->path = NULL;
+        program_cache_free_entry(entry);
         return NULL;
     }
+    entry->path = path;
+    entry->device = info ? info->st_dev : 0;
+    entry->inode = info ? info->st_ino : 0;
+    entry->mtimeNanos = info ? (long long)info->st_mtim.tv_sec * 1000000000LL + info->st_mtim.tv_nsec : 0;
+    entry->lines = count;
+    entry->id = programCacheNextID++;
+    return entry;
+}
+
+// Give a process its own copy of a cached program: one allocation holding
+// the line table, the decoded instructions, their operands and the text
+static int program_cache_copy(const ProgramCacheEntry* entry, ProcessArena* arena, PCB* pcb) {
+    memset(arena, 0, sizeof(*arena));
+    if (!variableScopeInit(&pcb->variables, entry->symbols, entry->symbolCount)) {
+        printf("Memory allocation failed\n");
+        return -1;
+    }
+    size_t tableBytes = entry->lines * sizeof(char*);
+    size_t codeBytes = entry->lines * sizeof(Instruction);
+    arena->size = tableBytes + codeBytes + entry->operandBytes + entry->textBytes;
+    arena->base = (char*)malloc(arena->size);
+    if (!arena->base) {
+        printf("Memory allocation failed\n");
+        variableScopeFree(&pcb->variables);
+        arena->size = 0;
+        return -1;
+    }
+    arena->used = arena->size;
+    char** table = (char**)arena->base;
+    Instruction* code = (Instruction*)(arena->base + tableBytes);
+    char* operands = arena->base + tableBytes + codeBytes;
+    char* text = operands + entry->operandBytes;
+    memcpy(code, entry->code, codeBytes);
+    memcpy(operands, entry->operands, entry->operandBytes);
+    memcpy(text, entry->text, entry->textBytes);
+    for (int i = 0; i < entry->lines; i++) {
+        table[i] = text + entry->offsets[i];
+    }
+    pcb->programText = table;
+    pcb->programLines = entry->lines;
+    pcb->code = code;
+    pcb->operands = operands;
+    return entry->lines;
+}
+
+// Load a program into a new process's arena through the cache, and report
+// the entry's id in *programID. Files that cannot be resolved or stat'ed are
+// read and decoded every time (id 0).
+static int program_cache_load(const char* fileName, PCB* pcb, int* programID) {
+    struct stat info;
+    *programID = 0;
+    writeBehindFlush();   // a program may have been written by another
+    char* path = realpath(fileName, NULL);
+    bool cacheable = path != NULL && stat(path, &info) == 0;
+    if (!cacheable) {
+        free(path);
+        path = NULL;
+    }
+
+    ProgramCacheEntry** slot = NULL;
+    ProgramCacheEntry* entry = NULL;
+    if (cacheable) {
+        long long mtimeNanos = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+        slot = programCacheSize ? program_cache_slot(path) : NULL;
+        entry = slot ? *slot : NULL;
+        if (entry != NULL && entry->device == (unsigned long long)info.st_dev &&
+            entry->inode == (unsigned long long)info.st_ino && entry->mtimeNanos == mtimeNanos) {
+            programCacheStats.hits++;
+            free(path);
+            *programID = entry->id;
+            return program_cache_copy(entry, &pcb->arena, pcb);
+        }
+        programCacheStats.misses++;
+        if (entry != NULL) {
+            programCacheStats.reloads++;
+        }
+    }
+
+    ProcessArena file;
+    char** lines;
+    int IC = readProgramFile(fileName, &file, &lines);
+    ProgramCacheEntry* fresh = IC > 0 ? program_cache_build(path, cacheable ? &info : NULL, lines, IC) : NULL;
+    arena_release(&file);
+    if (fresh == NULL) {
+        if (IC > 0) printf("Memory allocation failed\n");
+        free(path);
+        return IC > 0 ? -1 : IC;
+    }
+    int result = program_cache_copy(fresh, &pcb->arena, pcb);
+
+    if (!cacheable) {
+        program_cache_free_entry(fresh);
+    } else if (entry != NULL) {
+        program_cache_free_entry(entry);
+        *slot = fresh;
+        *programID = fresh->id;
+    } else if (program_cache_reserve()) {
+        *program_cache_slot(path) = fresh;
+        programCacheCount++;
+        *programID = fresh->id;
+    } else {
+        program_cache_free_entry(fresh);
+    }
+    return result;
+}
+
+// Drop every cached program
+void programCacheClear() {
+    for (int i = 0; i < programCacheSize; i++) {
+        if (programCache[i] != NULL) program_cache_free_entry(programCache[i]);
+    }
+    free(programCache);
+    programCache = NULL;
+    programCacheSize = 0;
+    programCacheCount = 0;
+}
 
+// Create a process
+PCB* createProcess(const char* fileName) {
     PCB* newProcess = (PCB*)malloc(sizeof(PCB));
     if (!newProcess) {
         printf("Failed to allocate PCB\n");
-        // Free instructions
-        for (int i = 0; i < IC; i++) {
-            free(instructions[i]);
-        }
-        free(instructions);
         return NULL;
     }
 
+    // Fills the arena, programText, programLines, code and operands
+    int programID;
+    int IC = program_cache_load(fileName, newProcess, &programID);
+    
+    if (IC <= 0) {
+        printf("Failed to read program file or no instructions found\n");
+        free(newProcess);
+        return NULL;
+    }
+    char** instructions = newProcess->programText;
+
     // Initialize PCB fields
     newProcess->processID = processCount+1;
     strcpy(newProcess->processState, "NEW");
+    newProcess->dirtyFields = 0;
+    newProcess->blockedSince = 0;
+    newProcess->resident = true;
+    newProcess->swapStart = -1;
+    newProcess->swapBlocks = 0;
+    newProcess->waitingForDisk = false;
+    newProcess->swapWords = 0;
+    newProcess->pageTable = NULL;
+    newProcess->pageCount = 0;
+    newProcess->text = NULL;
+    newProcess->wakeTime = 0;
+    newProcess->pageReferences = 0;
+    newProcess->pageFaults = 0;
+    newProcess->pageEvictions = 0;
+    newProcess->residentPages = 0;
+    newProcess->peakResidentPages = 0;
     newProcess->currentPriority = 0; 
-    newProcess->programCounter = p;
-    newProcess->lowerMemoryBound = p;
-    newProcess->upperMemoryBound = p + IC + 6 + 3-1;
+    newProcess->programCounter = 0;
     newProcess->next = NULL;
-    processCount++;
-    // Store instructions to memory
-    int j = 0;
-    for (int i = p; i < p + IC; i++) {
-        char temp[20];
-        sprintf(temp, "Instruction %d", j);
-        memory[i].name = strdup(temp);
-        memory[i].value = strdup(instructions[j]);
-        memory[i].processID = processCount;
-        j++;
+
+    // Processes running a cached program share its text in contiguous mode
+    if (shareText && !pagedMemory && programID != 0) {
+        newProcess->text = text_segment_acquire(programID, instructions, IC, newProcess);
+        if (newProcess->text == NULL) {
+            printf("Not enough memory to allocate process\n");
+            arena_release(&newProcess->arena);
+            variableScopeFree(&newProcess->variables);
+            free(newProcess);
+            return NULL;
+        }
     }
-    
-    // Free instructions array as they've been copied to memory
-    for (int i = 0; i < IC; i++) {
-        free(instructions[i]);
+
+    // Sets lowerMemoryBound and upperMemoryBound
+    if (!memoryAllocateImage(newProcess, IC + PROCESS_IMAGE_OVERHEAD)) {
+        printf("Not enough memory to allocate process\n");
+        if (newProcess->text != NULL) text_segment_release(newProcess->text);
+        arena_release(&newProcess->arena);
+        variableScopeFree(&newProcess->variables);
+        free(newProcess);
+        return NULL;
+    }
+    processCount++;
+    // Store instructions to memory; with demand paging most are loaded on first
+    // fetch, and shared text is already there
+    for (int j = 0; j < IC && newProcess->text == NULL; j++) {
+        if (!pcbPageLoaded(newProcess, j)) continue;
+        int i = pcbAddress(newProcess, j);
+        memoryWriteText(i, processCount, NAME_INSTRUCTION, instructions[j]);
+        memory[i].nameIndex = j;
     }
-    free(instructions);
     
     // Add variables to memory 
-    for(int i=p+IC; i<p+IC+3; i++){
-        memory[i].name = strdup("Variable");
-        memory[i].value = strdup("NULL");
-        memory[i].processID = processCount; 
+    for(int j=IC; j<IC+PROCESS_VARIABLE_WORDS; j++){
+        memoryWriteString(pcbAddress(newProcess, j), processCount, NAME_VARIABLE, "NULL");
     }
 
     // Skip 3 memory locations (the gap)
-    int currentIndex = p + IC + 3;  // Starting index for PCB
+    int currentIndex = IC + 3;  // Starting offset for PCB
     
     // Add PCB info to memory - all 6 fields in order
-    char temp[50];
-    
-    // 1. Process ID
-    sprintf(temp, "%d", newProcess->processID);
-    memory[currentIndex].name = strdup("PCB_ID");
-    memory[currentIndex].value = strdup(temp);
-    memory[currentIndex].processID = newProcess->processID;
-    currentIndex++;
-    
-    // 2. Process State
-    memory[currentIndex].name = strdup("processState");
-    memory[currentIndex].value = strdup(newProcess->processState);
-    memory[currentIndex].processID = newProcess->processID;
-    currentIndex++;
-    
-    // 3. Current Priority
-    sprintf(temp, "%d", newProcess->currentPriority);
-    memory[currentIndex].name = strdup("currentPriority");
-    memory[currentIndex].value = strdup(temp);
-    memory[currentIndex].processID = newProcess->processID;
-    currentIndex++;
-    
-    // 4. Program Counter
-    sprintf(temp, "%d", newProcess->programCounter);
-    memory[currentIndex].name = strdup("programCounter");
-    memory[currentIndex].value = strdup(temp);
-    memory[currentIndex].processID = newProcess->processID;
-    currentIndex++;
-    
-    // 5. Lower Memory Bound
-    sprintf(temp, "%d", newProcess->lowerMemoryBound);
-    memory[currentIndex].name = strdup("lowerMemoryBound");
-    memory[currentIndex].value = strdup(temp);
-    memory[currentIndex].processID = newProcess->processID;
-    currentIndex++;
-    
-    // 6. Upper Memory Bound
-    sprintf(temp, "%d", newProcess->upperMemoryBound);
-    memory[currentIndex].name = strdup("upperMemoryBound");
-    memory[currentIndex].value = strdup(temp);
-    memory[currentIndex].processID = newProcess->processID;
+    memoryWriteInt(pcbAddress(newProcess, currentIndex++), newProcess->processID, NAME_PCB_ID, newProcess->processID);
+    memoryWriteString(pcbAddress(newProcess, currentIndex++), newProcess->processID, NAME_PROCESS_STATE, newProcess->processState);
+    memoryWriteInt(pcbAddress(newProcess, currentIndex++), newProcess->processID, NAME_CURRENT_PRIORITY, newProcess->currentPriority);
+    memoryWriteInt(pcbAddress(newProcess, currentIndex++), newProcess->processID, NAME_PROGRAM_COUNTER, newProcess->programCounter);
+    memoryWriteInt(pcbAddress(newProcess, currentIndex++), newProcess->processID, NAME_LOWER_MEMORY_BOUND, newProcess->lowerMemoryBound);
+    memoryWriteInt(pcbAddress(newProcess, currentIndex), newProcess->processID, NAME_UPPER_MEMORY_BOUND, newProcess->upperMemoryBound);
     
     printf("Created process with ID %d from file %s\n", processCount+1, fileName);
    
-    printf("PCB stored at memory locations %d to %d\n", p + IC + 3, p + IC + 3 + 5);
+    printf("PCB stored at memory locations %d to %d\n", pcbAddress(newProcess, IC + 3), pcbAddress(newProcess, IC + 3 + 5));
    
     
     return newProcess;
@@ -357,11 +3032,39 @@ void semWait(Mutex* mutex, PCB* process) {
     } else {
         printf("Process %d is BLOCKED on %s\n", process->processID, mutex->resource);
         
-        strcpy(process->processState, "BLOCKED");
+        pcbSetState(process, "BLOCKED");
+        process->blockedSince = currentTime;
         addToBlockedQueue(&mutex->blockedQueue, process);
     }
 }
 
+// Put a process that is no longer blocked back in its ready queue
+void make_ready(PCB* process) {
+    pcbSetState(process, "READY");
+    
+    for (int i = 0; i < numProcesses; i++) {
+        if (processTable[i].pcb != NULL && processTable[i].pcb->processID == process->processID) {
+            if (algorithm == MLFQ) {
+                int level = processTable[i].currentQueueLevel;
+                int remainingQuantum = processTable[i].quantumRemaining;
+                
+                if (remainingQuantum <= 0 && level < NUM_MLFQ_LEVELS - 1) {
+                    level++;
+                    remainingQuantum = mlfqScheduler.timeQuantums[level];
+                }
+                
+                processTable[i].currentQueueLevel = level;
+                processTable[i].quantumRemaining = remainingQuantum;
+                
+                enqueue(&mlfqScheduler.queues[level], process);
+            } else {
+                enqueue(&readyQueue, process);
+            }
+            break;
+        }
+    }
+}
+
 // semSignal operation
 void semSignal(Mutex* mutex, PCB* process) {
     if (mutex->owner != process) {
@@ -372,30 +3075,8 @@ void semSignal(Mutex* mutex, PCB* process) {
     
     if (mutex->blockedQueue != NULL) {
         PCB* nextProcess = popBlockedQueue(&mutex->blockedQueue);
-        strcpy(nextProcess->processState, "READY");
         mutex->owner = nextProcess;
-        
-        for (int i = 0; i < numProcesses; i++) {
-            if (processTable[i].pcb != NULL && processTable[i].pcb->processID == nextProcess->processID) {
-                if (algorithm == MLFQ) {
-                    int level = processTable[i].currentQueueLevel;
-                    int remainingQuantum = processTable[i].quantumRemaining;
-                    
-                    if (remainingQuantum <= 0 && level < NUM_MLFQ_LEVELS - 1) {
-                        level++;
-                        remainingQuantum = mlfqScheduler.timeQuantums[level];
-                    }
-                    
-                    processTable[i].currentQueueLevel = level;
-                    processTable[i].quantumRemaining = remainingQuantum;
-                    
-                    enqueue(&mlfqScheduler.queues[level], nextProcess);
-                } else {
-                    enqueue(&readyQueue, nextProcess);
-                }
-                break;
-            }
-        }
+        make_ready(nextProcess);
         printf("Process %d is UNBLOCKED and acquired %s\n", nextProcess->processID, mutex->resource);
         
     } 
@@ -406,19 +3087,244 @@ void semSignal(Mutex* mutex, PCB* process) {
     }
 }
 
-//================================ Instruction Execution ===========================
+//================================ Disk Device ===========================
 
+// With --disk-io, file instructions do their work at once but the process
+// then waits BLOCKED for a simulated disk. The disk serves one transfer at a
+// time, picked from its queue by diskScheduling. A transfer takes diskLatency,
+// plus the seek to its file's cylinder at diskSeekRate cylinders per time
+// unit, plus size / diskBandwidth. Completion makes the process ready again,
+// like a serviced page fault.
+bool diskIO = false;
+int diskLatency = 2;             // time units of setup per request
+int diskBandwidth = 256;         // bytes transferred per time unit
+int diskCylinders = 200;
+int diskSeekRate = 50;           // cylinders the head crosses per time unit
+DiskSchedulingPolicy diskScheduling = DISK_FCFS;
+DiskStats diskStats = {0};
 
-// Find variable by name
-Variable* findVariable(const char* name) {
-    for (int i = 0; i < var_count; i++) {
-        if (strcmp(variables[i].name, name) == 0) {
-            return &variables[i];
+static DiskRequest* diskQueue = NULL;    // waiting requests, oldest first
+static DiskRequest* diskActive = NULL;   // request being transferred
+static int diskQueueLength = 0;
+static int diskHead = 0;                 // cylinder under the head
+static bool diskHeadUp = true;           // SCAN sweep direction
+
+// Files are spread over the cylinders by name
+static int disk_cylinder(const char* name, Variable* nameVar) {
+    if (!diskIO) {
+        return 0;
+    }
+    char number[24];
+    const char* text = nameVar ? value_text(&nameVar->value, number, sizeof(number)) : name;
+    if (text == NULL) {
+        return 0;
+    }
+    return (int)(fs_hash(text) % (unsigned int)diskCylinders);
+}
+
+// The queued request nearest the head in one direction (NULL if none)
+static DiskRequest** disk_nearest(bool up, bool anyDirection) {
+    DiskRequest** best = NULL;
+    int bestDistance = 0;
+    for (DiskRequest** link = &diskQueue; *link != NULL; link = &(*link)->next) {
+        int distance = (*link)->cylinder - diskHead;
+        if (!anyDirection && (up ? distance < 0 : distance > 0)) continue;
+        if (distance < 0) distance = -distance;
+        if (best == NULL || distance < bestDistance) {
+            best = link;
+            bestDistance = distance;
         }
     }
-    return NULL;
+    return best;
 }
 
+// Unlink the next request to serve and count the cylinders the head travels
+static DiskRequest* disk_pick(int* travel) {
+    DiskRequest** link = &diskQueue;
+    switch (diskScheduling) {
+        case DISK_FCFS:
+            break;
+        case DISK_SSTF:
+            link = disk_nearest(true, true);
+            break;
+        case DISK_SCAN:
+            link = disk_nearest(diskHeadUp, false);
+            if (link == NULL) {
+                // Run on to the edge, then sweep back
+                int edge = diskHeadUp ? diskCylinders - 1 : 0;
+                *travel += abs(edge - diskHead);
+                diskHead = edge;
+                diskHeadUp = !diskHeadUp;
+                link = disk_nearest(diskHeadUp, false);
+            }
+            break;
+        case DISK_CLOOK:
+            link = disk_nearest(true, false);
+            if (link == NULL) {
+                // Return to the lowest request
+                for (DiskRequest** l = &diskQueue; *l != NULL; l = &(*l)->next) {
+                    if (link == NULL || (*l)->cylinder < (*link)->cylinder) link = l;
+                }
+            }
+            break;
+    }
+    DiskRequest* request = *link;
+    *link = request->next;
+    *travel += abs(request->cylinder - diskHead);
+    diskHead = request->cylinder;
+    return request;
+}
+
+static void disk_start(int time) {
+    if (diskActive != NULL || diskQueue == NULL) {
+        return;
+    }
+    int travel = 0;
+    diskActive = disk_pick(&travel);
+    diskQueueLength--;
+    int service = diskLatency + (travel + diskSeekRate - 1) / diskSeekRate +
+                  (int)((diskActive->bytes + diskBandwidth - 1) / diskBandwidth);
+    diskActive->doneAt = time + service;
+    diskStats.busyCycles += service;
+    diskStats.seekDistance += travel;
+}
+
+// Queue a transfer for the process and block it until the disk finishes
+static void disk_request(PCB* process, bool write, long long bytes, int cylinder) {
+    if (!diskIO || process == NULL) {
+        return;
+    }
+    DiskRequest* request = (DiskRequest*)malloc(sizeof(DiskRequest));
+    if (!request) {
+        return;   // the transfer simply completes with the instruction
+    }
+    *request = (DiskRequest){ process, write, bytes, cylinder, currentTime, 0, NULL };
+    DiskRequest** link = &diskQueue;
+    while (*link != NULL) link = &(*link)->next;
+    *link = request;
+    diskStats.queueDepthSum += diskQueueLength + (diskActive ? 1 : 0);
+    if (++diskQueueLength > diskStats.maxQueue) {
+        diskStats.maxQueue = diskQueueLength;
+    }
+    diskStats.requests++;
+    diskStats.bytes += bytes;
+
+    pcbSetState(process, "BLOCKED");
+    process->blockedSince = currentTime;
+    process->waitingForDisk = true;
+    disk_start(currentTime);
+    printf("Time %d: Process %d waiting for disk %s of %lld bytes at cylinder %d\n",
+           currentTime, process->processID, write ? "write" : "read", bytes, cylinder);
+}
+
+// A process whose last instruction was the transfer has nothing left to
+// run, so the interrupt finishes it instead of making it ready. It is torn
+// down the way the active algorithm's own exit path does it.
+static void disk_process_exit(PCB* process) {
+    for (int i = 0; i < numProcesses; i++) {
+        if (processTable[i].pcb == process) {
+            printf("Process %d has completed execution at time %d\n", process->processID, currentTime);
+            pcbSetState(process, "TERMINATED");
+            memorySyncPCB(process);
+            processTable[i].isComplete = true;
+            memoryReleaseProcess(process);
+
+            char message[100];
+            snprintf(message, sizeof(message), "Process %d completed execution", process->processID);
+            log_message(gui, message);
+            if (algorithm == MLFQ) {
+                free(process);
+                processTable[i].pcb = NULL;
+            }
+            return;
+        }
+    }
+}
+
+// Completion interrupts: wake the processes whose transfers are done
+void check_disk_completions() {
+    while (diskActive != NULL && diskActive->doneAt <= currentTime) {
+        DiskRequest* done = diskActive;
+        diskActive = NULL;
+        done->process->waitingForDisk = false;
+        int latency = done->doneAt - done->issuedAt;
+        int bucket = 0;
+        while (bucket < DISK_LATENCY_BUCKETS - 1 && latency >= (2 << bucket)) bucket++;
+        diskStats.latency[bucket]++;
+        diskStats.waitCycles += latency;
+        diskStats.completed++;
+        if (!done->write) {
+            fileIOStats.readCycles += latency;   // queueing, seek and transfer
+        }
+        printf("Time %d: Process %d disk %s complete\n", currentTime, done->process->processID,
+               done->write ? "write" : "read");
+        if (done->process->programCounter >= done->process->programLines) {
+            disk_process_exit(done->process);
+        } else {
+            make_ready(done->process);
+        }
+        disk_start(done->doneAt);   // the next transfer began when this one ended
+        free(done);
+    }
+}
+
+void diskReset() {
+    while (diskQueue != NULL) {
+        DiskRequest* next = diskQueue->next;
+        free(diskQueue);
+        diskQueue = next;
+    }
+    free(diskActive);
+    diskActive = NULL;
+    diskQueueLength = 0;
+    diskHead = 0;
+    diskHeadUp = true;
+}
+
+static const char* diskPolicyNames[] = {"fcfs", "sstf", "scan", "c-look"};
+
+char* get_disk_stats_string() {
+    static char stats[280];
+    if (!diskIO) {
+        return "off";
+    }
+    int elapsed = currentTime > 0 ? currentTime : 1;
+    snprintf(stats, sizeof(stats),
+             "%s, %lld requests, %lld KB, %.0f%% busy, %.1f avg wait, %lld cylinders seeked (%.1f avg), "
+             "%.1f avg queue depth, %d queued (max %d), head at %d%s",
+             diskPolicyNames[diskScheduling], diskStats.requests, diskStats.bytes / 1024,
+             100.0 * diskStats.busyCycles / elapsed,
+             diskStats.completed ? (double)diskStats.waitCycles / diskStats.completed : 0.0,
+             diskStats.seekDistance,
+             diskStats.completed ? (double)diskStats.seekDistance / diskStats.completed : 0.0,
+             diskStats.requests ? (double)diskStats.queueDepthSum / diskStats.requests : 0.0,
+             diskQueueLength, diskStats.maxQueue, diskHead, diskActive ? ", transferring" : "");
+    return stats;
+}
+
+// Completed requests by issue-to-completion time, in power-of-two buckets
+char* get_disk_latency_string() {
+    static char stats[200];
+    if (!diskIO) {
+        return "off";
+    }
+    int length = 0;
+    stats[0] = '\0';
+    for (int bucket = 0; bucket < DISK_LATENCY_BUCKETS && length < (int)sizeof(stats); bucket++) {
+        int low = bucket ? 1 << bucket : 0;
+        if (bucket == DISK_LATENCY_BUCKETS - 1) {
+            length += snprintf(stats + length, sizeof(stats) - length, "%d+: %lld", low, diskStats.latency[bucket]);
+        } else {
+            length += snprintf(stats + length, sizeof(stats) - length, "%d-%d: %lld, ",
+                               low, (2 << bucket) - 1, diskStats.latency[bucket]);
+        }
+    }
+    return stats;
+}
+
+//================================ Instruction Execution ===========================
+
+
 // Check if a string is numeric
 int isNumeric(const char* value) {
     int start = (value[0] == '-') ? 1 : 0;
@@ -427,23 +3333,37 @@ int isNumeric(const char* value) {
             return 0;
         }
     }
-    return 1;
+    return 1;
+}
+
+static VariableScope looseVariables;   // for instructions run outside any process
+
+static VariableScope* variable_scope(PCB* process) {
+    return process != NULL ? &process->variables : &looseVariables;
+}
+
+static Variable* variable_at(VariableScope* scope, int slot) {
+    return slot < scope->count && scope->slots[slot].value.kind != VALUE_NONE ? &scope->slots[slot] : NULL;
+}
+
+static void variable_set(VariableScope* scope, int slot, const char* value) {
+    if (slot < 0 || !value_set_text(&scope->slots[slot].value, value)) {
+        printf("Error: No memory for variable value\n");
+    }
+}
+
+// Find variable by name
+Variable* findVariable(PCB* process, const char* name) {
+    VariableScope* scope = variable_scope(process);
+    int nameID = intern_lookup(name);
+    int slot = nameID < 0 ? -1 : variableScopeSlot(scope, nameID, false);
+    return slot >= 0 ? variable_at(scope, slot) : NULL;
 }
 
 // Set variable
-void setVariable(const char* name, const char* value) {
-    Variable* var = findVariable(name);
-    if (var == NULL) {
-        if (var_count < MAX_VARIABLES) {
-            var = &variables[var_count++];
-            strcpy(var->name, name);
-        } else {
-            printf("Error: Maximum number of variables reached\n");
-            return;
-        }
-    }
-    strcpy(var->value, value);
-    var->is_numeric = isNumeric(value);
+void setVariable(PCB* process, const char* name, const char* value) {
+    VariableScope* scope = variable_scope(process);
+    variable_set(scope, variableScopeSlot(scope, intern_name(name), true), value);
 }
 
 // print instruction
@@ -459,16 +3379,30 @@ void setVariable(const char* name, const char* value) {
        
 //     }
 // }
+// A decoded operand's variable: by slot when bound at load time, else by name
+static Variable* operand_variable(PCB* process, int slot, const char* name) {
+    return slot >= 0 ? variable_at(variable_scope(process), slot) : findVariable(process, name);
+}
+
+static int operand_slot(PCB* process, int slot, const char* name) {
+    return slot >= 0 ? slot : variableScopeSlot(variable_scope(process), intern_name(name), true);
+}
+
 // print instruction
-void print(const char* arg) {
-    Variable* var = findVariable(arg);
+void print(const char* arg, Variable* var) {
     if (var != NULL) {
+        char buffer[24];
+        const char* text = value_text(&var->value, buffer, sizeof(buffer));
+        if (text == NULL) {
+            log_message(gui, "Error: No memory to print variable");
+            return;
+        }
         // Print to console for debugging
-        printf("%s\n", var->value);
+        printf("%s\n", text);
         
         // Print to GUI output area
         if (gui) {
-            add_output_message(gui, var->value);
+            add_output_message(gui, text);
         }
     } else {
         // Print error message
@@ -593,105 +3527,113 @@ void print(const char* arg) {
 //     }
 // }
 // assign instruction
-void assign(const char* varName, const char* value, PCB* currentProcess) {
-    if (strcmp(value, "input") == 0) {
-        // Set up state for input dialog
-        waiting_for_input = true;
-        strncpy(pending_input_var, varName, sizeof(pending_input_var) - 1);
-        pending_input_var[sizeof(pending_input_var) - 1] = '\0';
-        pending_input_process = currentProcess;
+// Mirror an assigned variable into the process's memory words
+static void assign_store(const Instruction* ins, const char* varName, const char* value, PCB* currentProcess) {
+    if (currentProcess != NULL) {
+        Variable* var = operand_variable(currentProcess, ins->var1, varName);
+        bool stored = var != NULL
+            ? memoryStoreVariableAt(currentProcess, ins->slot, var->nameID, &var->value)
+            : memoryStoreVariable(currentProcess, varName, value);
         
-        // Pause simulation while waiting for input
-        if (gui->timer_id != 0) {
-            g_source_remove(gui->timer_id);
-            gui->timer_id = 0;
+        if (!stored) {
+            printf("Error: No space available in process memory for variable %s\n", varName);
+            log_message(gui, "Error: No memory space for variable");
         }
-        
-        // Show input dialog
-        bool numeric_only = (varName[0] >= 'a' && varName[0] <= 'z');
-        show_input_dialog(varName, numeric_only);
-        printf("Waiting for input...\n");
-        
-        // Return early - the rest will be handled via the dialog callback
-        return;
     }
-    else if (strncmp(value, "readFile", 8) == 0) {
-        char filename[100];
-        sscanf(value, "readFile %s", filename);
+}
 
-        Variable* fileVar = findVariable(filename);
-        const char* fname = fileVar ? fileVar->value : filename;
+// assign x input: ask the user through the GUI
+static void assign_input(const char* varName, PCB* currentProcess) {
+    // Set up state for input dialog
+    waiting_for_input = true;
+    strncpy(pending_input_var, varName, sizeof(pending_input_var) - 1);
+    pending_input_var[sizeof(pending_input_var) - 1] = '\0';
+    pending_input_process = currentProcess;
+    
+    // Pause simulation while waiting for input
+    if (gui->timer_id != 0) {
+        g_source_remove(gui->timer_id);
+        gui->timer_id = 0;
+    }
+    
+    // Show input dialog
+    bool numeric_only = (varName[0] >= 'a' && varName[0] <= 'z');
+    show_input_dialog(varName, numeric_only);
+    printf("Waiting for input...\n");
+    
+    // The rest is handled via the dialog callback
+}
 
-        FILE* f = fopen(fname, "r");
-        if (!f) {
-            printf("Error: Cannot read file '%s'\n", fname);
-            log_message(gui, "Error: Cannot read file");
-            return;
-        }
+// assign x readFile name: the contents of a file. 'dest' is varName's slot,
+// claimed before any operand was looked up. Returns the bytes read, or -1.
+static long long assign_from_file(const Instruction* ins, int dest, const char* varName, const char* filename,
+                                  Variable* fileVar, PCB* currentProcess) {
+    char number[24];
+    const char* fname = fileVar ? value_text(&fileVar->value, number, sizeof(number)) : filename;
+    if (fname == NULL) {
+        return -1;
+    }
 
-        char buffer[MAX_CONTENT_LENGTH] = "";
-        fread(buffer, 1, MAX_CONTENT_LENGTH, f);
+    writeBehindFlush();   // read back what earlier writeFiles produced
+    FILE* f = simulatedFS ? NULL : fopen(fname, "r");
+    Rope* contents = simulatedFS ? fs_read(fname) : NULL;
+    if (!f && !contents) {
+        printf("Error: Cannot read file '%s'\n", fname);
+        log_message(gui, "Error: Cannot read file");
+        return -1;
+    }
+
+    // The whole file, however large, shared from here on by reference
+    if (f) {
+        contents = ropeReadFile(f);
         fclose(f);
-        buffer[strcspn(buffer, "\0")] = '\0';
-        setVariable(varName, buffer);
     }
-    else {
-        if (isNumeric(value)) {
-            setVariable(varName, value);
-        } else {
-            Variable* srcVar = findVariable(value);
-            if (srcVar != NULL) {
-                setVariable(varName, srcVar->value);
-            } else {
-                printf("Error: Value '%s' is not valid\n", value);
-                log_message(gui, "Error: Invalid value");
-            }
-        }
+    long long bytes = contents ? (long long)contents->length : -1;
+    if (contents == NULL || dest < 0 || !value_set_rope(&variable_scope(currentProcess)->slots[dest].value, contents)) {
+        if (dest < 0) ropeRelease(contents);
+        printf("Error: No memory for variable value\n");
+        return -1;
     }
-    
-    // Update memory
-    if (currentProcess != NULL) {
-        int found = 0;
-        int start = currentProcess->lowerMemoryBound;
-        int end = currentProcess->upperMemoryBound - 6;
-        
-        for (int i = start + (end - start - 3); i < end; i++) {
-            if ((strcmp(memory[i].name, "Variable") == 0 && strcmp(memory[i].value, "NULL") == 0) ||
-                (memory[i].name != NULL && strcmp(memory[i].name, varName) == 0)) {
-                
-                if (memory[i].name != NULL && strcmp(memory[i].name, "Variable") == 0) {
-                    free(memory[i].name);
-                    memory[i].name = strdup(varName);
-                }
-                
-                if (memory[i].value != NULL) {
-                    free(memory[i].value);
-                }
-                
-                const char* valueToStore = value;
-                if (strcmp(value, "input") == 0) {
-                    Variable* var = findVariable(varName);
-                    if (var != NULL) {
-                        valueToStore = var->value;
-                    }
-                } else if (strncmp(value, "readFile", 8) == 0) {
-                    Variable* var = findVariable(varName);
-                    if (var != NULL) {
-                        valueToStore = var->value;
-                    }
-                }
-                
-                memory[i].value = strdup(valueToStore);
-                found = 1;
-                break;
-            }
-        }
-        
-        if (!found) {
-            printf("Error: No space available in process memory for variable %s\n", varName);
-            log_message(gui, "Error: No memory space for variable");
+    assign_store(ins, varName, "", currentProcess);
+    return bytes;
+}
+
+// assign x value: a number or another variable
+static void assign_value(const Instruction* ins, int dest, const char* varName, const char* value,
+                         Variable* srcVar, PCB* currentProcess) {
+    if (isNumeric(value)) {
+        variable_set(variable_scope(currentProcess), dest, value);
+    } else {
+        if (srcVar != NULL) {
+            if (dest >= 0) value_copy(&variable_scope(currentProcess)->slots[dest].value, &srcVar->value);
+        } else {
+            printf("Error: Value '%s' is not valid\n", value);
+            log_message(gui, "Error: Invalid value");
         }
     }
+    assign_store(ins, varName, value, currentProcess);
+}
+
+// assign x 42: the literal was parsed when the program was decoded
+static void assign_number(const Instruction* ins, int dest, const char* varName, const char* value,
+                          PCB* currentProcess) {
+    if (dest >= 0) value_set_int(&variable_scope(currentProcess)->slots[dest].value, ins->number);
+    assign_store(ins, varName, value, currentProcess);
+}
+
+// Write 'value' in decimal without a terminator; returns its length
+static size_t format_int(char* out, long long value) {
+    char digits[20];
+    int n = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    size_t length = 0;
+    if (value < 0) out[length++] = '-';
+    while (n > 0) out[length++] = digits[--n];
+    return length;
 }
 
 // printFromTo instruction
@@ -733,64 +3675,154 @@ void assign(const char* varName, const char* value, PCB* currentProcess) {
 // }
 
 // // writeFile instruction
-void writeFile(const char* filename, const char* content) {
-    Variable* fileVar = findVariable(filename);
-    const char* fileNameStr = fileVar ? fileVar->value : filename;
+// Returns the bytes written, or -1
+long long writeFile(const char* filename, Variable* fileVar, const char* content, Variable* contentVar) {
+    char number[24];
+    const char* fileNameStr = fileVar ? value_text(&fileVar->value, number, sizeof(number)) : filename;
+    if (fileNameStr == NULL) {
+        return -1;
+    }
 
-    const char* actualContent = content;
-    Variable* contentVar = findVariable(content);
+    Value literal = { VALUE_NONE };
+    const Value* data = &literal;
     if (contentVar != NULL) {
-        actualContent = contentVar->value;
+        data = &contentVar->value;   // shared, not copied
     } else if (content[0] == '"') {
-        actualContent = content + 1;
+        if (!value_set_text(&literal, content + 1)) {
+            printf("Error: No memory for file contents\n");
+            return -1;
+        }
     } else {
         printf("Error: Content must be a string or variable\n");
         
-        return;
+        return -1;
     }
-
-    FILE* file = fopen(fileNameStr, "w");
-    if (file == NULL) {
-        printf("Error: Could not open file '%s' for writing\n", fileNameStr);
-        
-        return;
+    long long bytes = (long long)value_length(data);
+    bool stored = simulatedFS ? fs_write(fileNameStr, data) : write_behind_queue(fileNameStr, data);
+    value_release(&literal);
+    if (!stored) {
+        printf("Error: Could not write file '%s'\n", fileNameStr);
+        return -1;
     }
+    fileIOStats.writes++;
 
-    fprintf(file, "%s", actualContent);
-    
-    fclose(file);
-    printf("Data written to '%s'\n", fileNameStr);
-   
+    printf(simulatedFS || writeBehindBytes == 0 ? "Data written to '%s'\n" : "Data queued for '%s'\n",
+           fileNameStr);
+    return bytes;
 }
 
 // readFile instruction
-void readFile(const char* filename) {
-    Variable* fileVar = findVariable(filename);
-    const char* fileNameStr = fileVar ? fileVar->value : filename;
+FileIOStats fileIOStats = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-    FILE* file = fopen(fileNameStr, "r");
-    if (file == NULL) {
-        printf("Error: Could not open file '%s' for reading\n", fileNameStr);
-        
-        return;
+// Send file contents to the console and the output panel
+static void output_contents(const char* text, size_t length) {
+    fwrite(text, 1, length, stdout);
+    if (gui) {
+        add_output_text(gui, text, length);
     }
+}
+
+static void output_rope(Rope* contents) {
+    ropeWrite(contents, stdout);
+    if (gui) add_output_rope(gui, contents);   // chunk by chunk, never flattened
+}
 
-    char buffer[MAX_CONTENT_LENGTH];
+// Stream a host file to the output sinks. Regular files are mapped and
+// handed over page by page as they are touched; anything that cannot be
+// mapped is read in rope-sized chunks.
+static bool output_host_file(const char* fileNameStr, size_t* bytes) {
+    int fd = open(fileNameStr, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
     printf("Contents of '%s':\n", fileNameStr);
-    
-    while (fgets(buffer, sizeof(buffer), file) != NULL) {
-        printf("%s", buffer);
+
+    struct stat info;
+    size_t size = 0;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        size = (size_t)info.st_size;
+        char* text = (char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text != MAP_FAILED) {
+            madvise(text, size, MADV_SEQUENTIAL);
+            output_contents(text, size);
+            munmap(text, size);
+        } else {
+            size = 0;
+        }
+    }
+    if (size == 0) {
+        FILE* file = fdopen(fd, "r");
+        Rope* contents = file ? ropeReadFile(file) : NULL;
+        if (contents != NULL) {
+            size = contents->length;
+            output_rope(contents);
+            ropeRelease(contents);
+        }
+        if (file) fclose(file);
+        else close(fd);
+    } else {
+        close(fd);
+    }
+    *bytes = size;
+    return true;
+}
+
+// readFile instruction: send the file to the console and the output panel.
+// Returns the bytes read, or -1.
+long long readFile(const char* filename, Variable* fileVar) {
+    char number[24];
+    const char* fileNameStr = fileVar ? value_text(&fileVar->value, number, sizeof(number)) : filename;
+    if (fileNameStr == NULL) {
+        return -1;
+    }
+
+    writeBehindFlush();
+    long long started = now_nanos();
+    size_t size = 0;
+    Rope* contents = simulatedFS ? fs_read(fileNameStr) : NULL;
+    if (contents != NULL) {
+        printf("Contents of '%s':\n", fileNameStr);
+        size = contents->length;
+        output_rope(contents);
+        ropeRelease(contents);
+    } else if (simulatedFS || !output_host_file(fileNameStr, &size)) {
+        printf("Error: Could not open file '%s' for reading\n", fileNameStr);
         
+        return -1;
+    }
+
+    fileIOStats.reads++;
+    fileIOStats.bytesRead += (long long)size;
+    if (!diskIO) {
+        fileIOStats.readCycles++;   // no device model: the instruction is the whole read
+    }
+    fileIOStats.readNanos += now_nanos() - started;
+    return (long long)size;
+}
+
+char* get_file_io_stats_string() {
+    static char stats[384];
+    long long nanos = fileIOStats.readNanos;
+    int length = snprintf(stats, sizeof(stats), "%lld reads, %lld KB, %lld bytes/cycle, %lld MB/s streamed; "
+             "%lld writes (%lld coalesced, %lld failed), %lld KB in %lld batches, %lld fsyncs",
+             fileIOStats.reads, fileIOStats.bytesRead / 1024,
+             fileIOStats.readCycles ? fileIOStats.bytesRead / fileIOStats.readCycles : 0,
+             nanos ? fileIOStats.bytesRead * 1000 / nanos : 0,
+             fileIOStats.writes, fileIOStats.writesCoalesced, fileIOStats.writeErrors,
+             fileIOStats.bytesWritten / 1024,
+             fileIOStats.writeBatches, fileIOStats.fsyncs);
+    if (simulatedFS && length < (int)sizeof(stats)) {
+        snprintf(stats + length, sizeof(stats) - length, "; simulated fs: %d files in %d blocks",
+                 fsInodeCount, fsBlockCount - fsFreeBlockCount);
     }
-    fclose(file);
+    return stats;
 }
-void printFromTo(const char* startStr, const char* endStr) {
+void printFromTo(const char* startStr, Variable* startVar, const char* endStr, Variable* endVar) {
     int start, end;
-    Variable* startVar = findVariable(startStr);
-    Variable* endVar = findVariable(endStr);
+    long long number;
 
-    if (startVar != NULL && startVar->is_numeric) {
-        start = atoi(startVar->value);
+    if (startVar != NULL && value_number(&startVar->value, &number)) {
+        start = (int)number;
     } else if (isNumeric(startStr)) {
         start = atoi(startStr);
     } else {
@@ -803,8 +3835,8 @@ void printFromTo(const char* startStr, const char* endStr) {
         return;
     }
 
-    if (endVar != NULL && endVar->is_numeric) {
-        end = atoi(endVar->value);
+    if (endVar != NULL && value_number(&endVar->value, &number)) {
+        end = (int)number;
     } else if (isNumeric(endStr)) {
         end = atoi(endStr);
     } else {
@@ -817,64 +3849,181 @@ void printFromTo(const char* startStr, const char* endStr) {
         return;
     }
 
-    // Construct output for both console and GUI
-    char output[1024] = "";
+    // Format the range ("3 4 5 ") one bounded chunk at a time; each chunk
+    // goes to the console and on to a single GUI output line
+    static char chunk[OUTPUT_CHUNK_SIZE];
+    OutputLine line;
+    output_line_begin(gui, &line);
     int step = (start <= end) ? 1 : -1;
-    
-    for (int i = start; (step == 1 ? i <= end : i >= end); i += step) {
-        char num_str[20];
-        snprintf(num_str, sizeof(num_str), "%d ", i);
-        strcat(output, num_str);
-    }
-    
-    // Print to console
-    printf("%s\n", output);
-    
-    // Print to GUI output area
-    if (gui) {
-        add_output_message(gui, output);
+    long long count = (long long)(step == 1 ? end - (long long)start : start - (long long)end) + 1;
+    size_t length = 0;
+    for (long long k = 0, i = start; k < count; k++, i += step) {
+        length += format_int(chunk + length, i);
+        chunk[length++] = ' ';
+        if (length > sizeof(chunk) - 24 || k + 1 == count) {   // room for one more number
+            fwrite(chunk, 1, length, stdout);
+            output_line_append(gui, &line, chunk, length);
+            length = 0;
+        }
     }
+    putchar('\n');
+    output_line_end(gui, &line);
 }
-// // Execute a single instruction
-void execute(char* line, PCB* currentProcess) {
-    char command[20], arg1[100], arg2[100];
-    int numArgs = sscanf(line, "%19s %99s %99[^\n]", command, arg1, arg2);
+//================================ Dispatch ===========================
 
-    if (strcmp(command, "print") == 0 && numArgs >= 2) {
-        print(arg1);
-    } 
-    else if (strcmp(command, "assign") == 0 && numArgs == 3) {
-        assign(arg1, arg2, currentProcess);
-    }
-    else if (strcmp(command, "printFromTo") == 0 && numArgs == 3) {
-        printFromTo(arg1, arg2);
-    }
-    else if (strcmp(command, "writeFile") == 0 && numArgs == 3) {
-        writeFile(arg1, arg2);
-    }
-    else if (strcmp(command, "readFile") == 0 && numArgs == 2) {
-        readFile(arg1);
-    }
-    else if (strcmp(command, "semWait") == 0 && numArgs == 2) {
-        if (strcmp(arg1, "file") == 0)
-            semWait(&fileMutex, currentProcess);
-        else if (strcmp(arg1, "userInput") == 0)
-            semWait(&inputMutex, currentProcess);
-        else if (strcmp(arg1, "userOutput") == 0)
-            semWait(&outputMutex, currentProcess);
-    }
-    else if (strcmp(command, "semSignal") == 0 && numArgs == 2) {
-        if (strcmp(arg1, "file") == 0)
-            semSignal(&fileMutex, currentProcess);
-        else if (strcmp(arg1, "userInput") == 0)
-            semSignal(&inputMutex, currentProcess);
-        else if (strcmp(arg1, "userOutput") == 0)
-            semSignal(&outputMutex, currentProcess);
+// Run critical sections as a single step when their lock is free
+bool fuseCriticalSections = false;
+DispatchStats dispatchStats = {0, 0, 0, 0};
+
+static int op_invalid(const Instruction* ins, const char* operands, PCB* process) {
+    (void)process;
+    printf("Error: Unknown command '%s'\n", operands + ins->arg1);
+    return 1;
+}
+
+static int op_print(const Instruction* ins, const char* operands, PCB* process) {
+    const char* arg1 = operands + ins->arg1;
+    print(arg1, operand_variable(process, ins->var1, arg1));
+    return 1;
+}
+
+static int op_assign(const Instruction* ins, const char* operands, PCB* process) {
+    const char* arg1 = operands + ins->arg1;
+    const char* arg2 = operands + ins->arg2;
+    int dest = operand_slot(process, ins->var1, arg1);
+    assign_value(ins, dest, arg1, arg2, isNumeric(arg2) ? NULL : operand_variable(process, ins->var2, arg2), process);
+    return 1;
+}
+
+static int op_assign_number(const Instruction* ins, const char* operands, PCB* process) {
+    const char* arg1 = operands + ins->arg1;
+    assign_number(ins, operand_slot(process, ins->var1, arg1), arg1, operands + ins->arg2, process);
+    return 1;
+}
+
+static int op_assign_input(const Instruction* ins, const char* operands, PCB* process) {
+    assign_input(operands + ins->arg1, process);
+    return 1;
+}
+
+static int op_assign_read_file(const Instruction* ins, const char* operands, PCB* process) {
+    const char* arg1 = operands + ins->arg1;
+    const char* arg2 = operands + ins->arg2;
+    int dest = operand_slot(process, ins->var1, arg1);
+    Variable* fileVar = operand_variable(process, ins->var2, arg2);
+    int cylinder = disk_cylinder(arg2, fileVar);   // before x may overwrite the name
+    long long bytes = assign_from_file(ins, dest, arg1, arg2, fileVar, process);
+    if (bytes >= 0) disk_request(process, false, bytes, cylinder);
+    return 1;
+}
+
+static int op_print_from_to(const Instruction* ins, const char* operands, PCB* process) {
+    const char* arg1 = operands + ins->arg1;
+    const char* arg2 = operands + ins->arg2;
+    printFromTo(arg1, operand_variable(process, ins->var1, arg1), arg2, operand_variable(process, ins->var2, arg2));
+    return 1;
+}
+
+static int op_write_file(const Instruction* ins, const char* operands, PCB* process) {
+    const char* arg1 = operands + ins->arg1;
+    const char* arg2 = operands + ins->arg2;
+    Variable* fileVar = operand_variable(process, ins->var1, arg1);
+    long long bytes = writeFile(arg1, fileVar, arg2, operand_variable(process, ins->var2, arg2));
+    if (bytes >= 0) disk_request(process, true, bytes, disk_cylinder(arg1, fileVar));
+    return 1;
+}
+
+static int op_read_file(const Instruction* ins, const char* operands, PCB* process) {
+    const char* arg1 = operands + ins->arg1;
+    Variable* fileVar = operand_variable(process, ins->var1, arg1);
+    long long bytes = readFile(arg1, fileVar);
+    if (bytes >= 0) disk_request(process, false, bytes, disk_cylinder(arg1, fileVar));
+    return 1;
+}
+
+static int op_sem_wait(const Instruction* ins, const char* operands, PCB* process) {
+    (void)operands;
+    if (ins->mutex != NULL) semWait(ins->mutex, process);
+    return 1;
+}
+
+static int op_sem_signal(const Instruction* ins, const char* operands, PCB* process) {
+    (void)operands;
+    if (ins->mutex != NULL) semSignal(ins->mutex, process);
+    return 1;
+}
+
+static int op_critical_section(const Instruction* ins, const char* operands, PCB* process);
+
+static const InstructionHandler instructionHandlers[OP_COUNT] = {
+    [OP_INVALID] = op_invalid,
+    [OP_PRINT] = op_print,
+    [OP_ASSIGN] = op_assign,
+    [OP_ASSIGN_NUMBER] = op_assign_number,
+    [OP_ASSIGN_INPUT] = op_assign_input,
+    [OP_ASSIGN_READ_FILE] = op_assign_read_file,
+    [OP_PRINT_FROM_TO] = op_print_from_to,
+    [OP_WRITE_FILE] = op_write_file,
+    [OP_READ_FILE] = op_read_file,
+    [OP_SEM_WAIT] = op_sem_wait,
+    [OP_SEM_SIGNAL] = op_sem_signal,
+    [OP_CRITICAL_SECTION] = op_critical_section,
+};
+
+// semWait X; op; semSignal X. When fusing is on and X is free, the whole
+// section runs now; otherwise this is a plain semWait.
+static int op_critical_section(const Instruction* ins, const char* operands, PCB* process) {
+    int pc = process->programCounter;
+    bool fuse = fuseCriticalSections && !ins->mutex->locked && &process->code[pc] == ins &&
+                pcbPageLoaded(process, pc + 1) && pcbPageLoaded(process, pc + 2);
+    semWait(ins->mutex, process);
+    if (!fuse) {
+        return 1;
     }
-    else {
-       printf("Error: Unknown command '%s'\n", command);
-        
+    memoryTouchPage(process, pc + 1);
+    memoryTouchPage(process, pc + 2);
+    instructionHandlers[ins[1].opcode](&ins[1], operands, process);
+    if (strcmp(process->processState, "RUNNING") != 0) {
+        return 2;   // waiting for the disk: X stays held, semSignal runs on wake-up
     }
+    semSignal(ins[2].mutex, process);
+    printf("Process %d ran its %s critical section in one step\n", process->processID, ins->mutex->resource);
+    dispatchStats.fusedSections++;
+    return 3;
+}
+
+// Run a decoded instruction; operands are offsets into 'operands'.
+// Returns how many program instructions it covered.
+int execute_instruction(const Instruction* ins, const char* operands, PCB* currentProcess) {
+    long long start = now_nanos();
+    int executed = instructionHandlers[ins->opcode](ins, operands, currentProcess);
+    dispatchStats.hostNanos += now_nanos() - start;
+    dispatchStats.dispatches++;
+    dispatchStats.instructions += executed;
+    return executed;
+}
+
+char* get_dispatch_stats_string() {
+    static char stats[224];
+    // Simulated instructions per second of host time spent running them
+    double perSecond = dispatchStats.hostNanos > 0
+                       ? dispatchStats.instructions * 1e9 / dispatchStats.hostNanos : 0;
+    snprintf(stats, sizeof(stats), "%lld instructions in %lld dispatches (%.0f per host second), "
+             "%lld fused critical sections%s",
+             dispatchStats.instructions, dispatchStats.dispatches, perSecond, dispatchStats.fusedSections,
+             fuseCriticalSections ? "" : " (fusing off)");
+    return stats;
+}
+
+// Execute a single instruction given as text (decoded on the spot)
+void execute(const char* line, PCB* currentProcess) {
+    Instruction ins;
+    char* operands = NULL;
+    size_t size = 0, capacity = 0;
+    operand_add(&operands, &size, &capacity, "");
+    decode_instruction(line, &ins, NULL, &operands, &size, &capacity);
+    execute_instruction(&ins, operands ? operands : "", currentProcess);
+    free(operands);
 }
 
 
@@ -882,6 +4031,36 @@ void execute(char* line, PCB* currentProcess) {
 
 
 
+// Make sure the process table can hold at least 'needed' entries
+bool ensure_process_table_capacity(int needed) {
+    if (needed <= processTableCapacity) {
+        return true;
+    }
+    int newCapacity = processTableCapacity ? processTableCapacity : PROCESS_TABLE_INITIAL_SIZE;
+    while (newCapacity < needed) newCapacity *= 2;
+
+    ProcessTableEntry* grown = (ProcessTableEntry*)realloc(processTable, newCapacity * sizeof(ProcessTableEntry));
+    if (!grown) {
+        return false;
+    }
+    for (int i = processTableCapacity; i < newCapacity; i++) {
+        grown[i].pcb = NULL;
+        grown[i].filename[0] = '\0';
+        grown[i].arrivalTime = 0;
+        grown[i].burstTime = 0;
+        grown[i].executedTime = 0;
+        grown[i].waitingTime = 0;
+        grown[i].priority = 0;
+        grown[i].currentQueueLevel = 0;
+        grown[i].quantumRemaining = 0;
+        grown[i].hasArrived = false;
+        grown[i].isComplete = false;
+    }
+    processTable = grown;
+    processTableCapacity = newCapacity;
+    return true;
+}
+
 // Add this simulation initialization function
 void initialize_simulation() {
     // Initialize memory
@@ -914,32 +4093,17 @@ void initialize_simulation() {
     currentTime = 0;
     currentRunningProcess = NULL;
     if (processTable == NULL) {
-        processTable = (ProcessTableEntry*)malloc(MAX_PROCESSES * sizeof(ProcessTableEntry));
-        if (processTable == NULL) {
+        if (!ensure_process_table_capacity(PROCESS_TABLE_INITIAL_SIZE)) {
             fprintf(stderr, "Failed to allocate process table\n");
             log_message(gui, "Failed to allocate process table\n");
             log_message(gui,"/n");
             return;
         }
 
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        processTable[i].pcb = NULL;
-        processTable[i].filename[0] = '\0';
-        processTable[i].arrivalTime = 0;
-        processTable[i].burstTime = 0;
-        processTable[i].executedTime = 0;
-        processTable[i].waitingTime = 0;
-        processTable[i].priority = 0;
-        processTable[i].currentQueueLevel = 0;
-        processTable[i].quantumRemaining = 0;
-        processTable[i].hasArrived = false;
-        processTable[i].isComplete = false;
-    }
-
     numProcesses = 0;
     //currentTime = -1;//test
     processCount = 0;
-    var_count = 0;
+    variableScopeFree(&looseVariables);
     currentRunningProcess = NULL;
 }
 }
@@ -947,14 +4111,21 @@ void initialize_simulation() {
 // This function checks for and handles processes that have arrived at the current time
 void check_for_process_arrivals(int currentTime) {
     int numArrivingProcesses = 0;
-    PCB* arrivingProcesses[MAX_PROCESSES];
-    int priorityValues[MAX_PROCESSES];
+    PCB** arrivingProcesses = (PCB**)malloc((numProcesses + 1) * sizeof(PCB*));
+    int* priorityValues = (int*)malloc((numProcesses + 1) * sizeof(int));
+    if (!arrivingProcesses || !priorityValues) {
+        printf("Error: Failed to allocate arrival list\n");
+        free(arrivingProcesses);
+        free(priorityValues);
+        return;
+    }
     
     printf("Checking for process arrivals at time %d\n", currentTime);
     
     // Check all processes in process table
     for (int i = 0; i < numProcesses; i++) {
-        if (!processTable[i].hasArrived && processTable[i].arrivalTime == currentTime) {
+        // '<=' so that a process that could not be admitted yet is retried
+        if (!processTable[i].hasArrived && processTable[i].arrivalTime <= currentTime) {
             // Process arrival time has been reached
             
             // Create PCB if not already created
@@ -971,9 +4142,7 @@ void check_for_process_arrivals(int currentTime) {
                 processTable[i].pcb = pcb;
                 
                 // Calculate burst time now that we have memory bounds
-                int instructionCount = pcb->upperMemoryBound - 
-                                      pcb->lowerMemoryBound + 1 - 9;
-                processTable[i].burstTime = instructionCount;
+                processTable[i].burstTime = pcbInstructionCount(pcb);
             }
             
             // Mark as arrived AFTER successful creation
@@ -983,7 +4152,7 @@ void check_for_process_arrivals(int currentTime) {
                 currentTime, processTable[i].pcb->processID, processTable[i].pcb->currentPriority);
             
             // Set the process state to READY
-            strcpy(processTable[i].pcb->processState, "READY");
+            pcbSetState(processTable[i].pcb, "READY");
             
             // Add to our temporary array - use the current count as index, then increment
             arrivingProcesses[numArrivingProcesses] = processTable[i].pcb; 
@@ -1044,6 +4213,9 @@ void check_for_process_arrivals(int currentTime) {
             }
         }
     }
+
+    free(arrivingProcesses);
+    free(priorityValues);
 }
 
 bool all_processes_complete() {
@@ -1068,9 +4240,10 @@ void run_fcfs_scheduler() {
         PCB* currentProcess = dequeue(&readyQueue);
         
         if (currentProcess != NULL) {
-            strcpy(currentProcess->processState, "RUNNING");
+            memorySwapIn(currentProcess);
+            pcbSetState(currentProcess, "RUNNING");
             printf("Time %d: Program %d is now running\n", currentTime, currentProcess->processID);
-            memory[currentProcess->upperMemoryBound-4].value = currentProcess->processState; // update process state in memory
+            memorySyncPCB(currentProcess); // update process state in memory
 
             
             // Find the process entry to determine burst time
@@ -1090,25 +4263,17 @@ void run_fcfs_scheduler() {
             while (remainingInstructions > 0)  {
                  
                 
-                int memoryIndex = currentProcess->programCounter;
+                int memoryIndex = pcbAddress(currentProcess, currentProcess->programCounter);
                 
                 // Execute the instruction
                 printf("Time %d: Executing process %d, instruction: %s\n", 
-                       currentTime, currentProcess->processID, memory[memoryIndex].value);
+                       currentTime, currentProcess->processID, memoryWordText(memoryIndex));
                 
-                execute(memory[memoryIndex].value, currentProcess); // Execute the instruction      
+                int executed = execute_instruction(&currentProcess->code[currentProcess->programCounter], currentProcess->operands, currentProcess); // Execute the instruction      
                 // Update program counter
-                currentProcess->programCounter++;
-                // Create a temporary buffer for the string conversion
-                 char tempBuffer[20];
-                // Convert the integer to a string
-                sprintf(tempBuffer, "%d", currentProcess->programCounter);
-                // Free the old value to prevent memory leaks
-                if (memory[currentProcess->upperMemoryBound-2].value != NULL) {
-                    free(memory[currentProcess->upperMemoryBound-2].value);
-                    }
-                // Allocate and store the new string value
-                memory[currentProcess->upperMemoryBound-2].value = strdup(tempBuffer); // update pc in memory
+                currentProcess->programCounter += executed;
+                // Update program counter in memory
+                pcbMarkDirty(currentProcess, PCB_DIRTY_COUNTER);
               // displayMemory(); // Display memory after each instruction execution
              
                 
@@ -1134,8 +4299,8 @@ void run_fcfs_scheduler() {
             
             // Process is now complete
             printf("Process %d has completed execution at time %d\n", currentProcess->processID, currentTime);
-            strcpy(currentProcess->processState, "TERMINATED");
-            memory[currentProcess->upperMemoryBound-4].value = currentProcess->processState; // update process state in memory
+            pcbSetState(currentProcess, "TERMINATED");
+            memorySyncPCB(currentProcess); // update process state in memory
             
             // Mark process as complete in process table
             if (processIndex != -1) {
@@ -1168,7 +4333,8 @@ void run_rr_scheduler(int timeQuantum) {
         if (currentProcess == NULL) {
             currentProcess = dequeue(&readyQueue);
             if (currentProcess != NULL) {
-                strcpy(currentProcess->processState, "RUNNING");
+                memorySwapIn(currentProcess);
+                pcbSetState(currentProcess, "RUNNING");
                 printf("Time %d: Process %d is now running\n", currentTime, currentProcess->processID);
                 remainingQuantum = timeQuantum;
             }
@@ -1193,29 +4359,21 @@ void run_rr_scheduler(int timeQuantum) {
             
             if (processIndex != -1) {  // Make sure we found the process
                 // Calculate the position of the last instruction
-                int lastInstructionPosition = currentProcess->upperMemoryBound - 9;
+                int lastInstructionPosition = pcbInstructionCount(currentProcess) - 1;
                 
                 // Execute one instruction only if we haven't reached the end
                 if (currentProcess->programCounter <= lastInstructionPosition) {
-                    int memoryIndex = currentProcess->programCounter;
+                    int memoryIndex = pcbAddress(currentProcess, currentProcess->programCounter);
                     
                     printf("Time %d: Executing process %d, instruction: %s (Quantum remaining: %d)\n", 
-                           currentTime, currentProcess->processID, memory[memoryIndex].value, remainingQuantum);
+                           currentTime, currentProcess->processID, memoryWordText(memoryIndex), remainingQuantum);
                     
-                    execute(memory[memoryIndex].value, currentProcess);                
-                    currentProcess->programCounter++;
+                    int executed = execute_instruction(&currentProcess->code[currentProcess->programCounter], currentProcess->operands, currentProcess);                
+                    currentProcess->programCounter += executed;
                     processTable[processIndex].executedTime++;
                     
-                    // Create a temporary buffer for the string conversion
-                    char tempBuffer[20];
-                    // Convert the integer to a string
-                    sprintf(tempBuffer, "%d", currentProcess->programCounter);
-                    // Free the old value to prevent memory leaks
-                    if (memory[currentProcess->upperMemoryBound-2].value != NULL) {
-                        free(memory[currentProcess->upperMemoryBound-2].value);
-                    }
-                    // Allocate and store the new string value
-                    memory[currentProcess->upperMemoryBound-2].value = strdup(tempBuffer);
+                    // Update program counter in memory
+                    pcbMarkDirty(currentProcess, PCB_DIRTY_COUNTER);
                     
                     remainingQuantum--;
                     
@@ -1228,7 +4386,7 @@ void run_rr_scheduler(int timeQuantum) {
                     // Check if process has completed all its instructions
                     else if (currentProcess->programCounter > lastInstructionPosition) {
                         printf("Process %d has completed execution at time %d\n", currentProcess->processID, currentTime + 1);
-                        strcpy(currentProcess->processState, "TERMINATED");
+                        pcbSetState(currentProcess, "TERMINATED");
                         processTable[processIndex].isComplete = true;
                         currentProcess = NULL;
                     }
@@ -1236,14 +4394,14 @@ void run_rr_scheduler(int timeQuantum) {
                     else if (remainingQuantum <= 0) {
                         printf("Time %d: Process %d time quantum expired, moving to ready queue\n", 
                                currentTime, currentProcess->processID);
-                        strcpy(currentProcess->processState, "READY");
+                        pcbSetState(currentProcess, "READY");
                         enqueue(&readyQueue, currentProcess);
                         currentProcess = NULL;
                     }
                 } else {
                     // Process completed all instructions
                     printf("Process %d has completed execution at time %d\n", currentProcess->processID, currentTime);
-                    strcpy(currentProcess->processState, "TERMINATED");
+                    pcbSetState(currentProcess, "TERMINATED");
                     processTable[processIndex].isComplete = true;
                     currentProcess = NULL;
                 }
@@ -1283,6 +4441,7 @@ void run_mlfq_scheduler() {
             for (int level = 0; level < NUM_MLFQ_LEVELS; level++) {
                 currentProcess = dequeue(&mlfqScheduler.queues[level]);
                 if (currentProcess != NULL) {
+                    memorySwapIn(currentProcess);
                     currentLevel = level;
                     
                     // Find the process in the process table to get its remaining quantum
@@ -1294,11 +4453,8 @@ void run_mlfq_scheduler() {
                     }
                     
                     // Update process state
-                    strcpy(currentProcess->processState, "RUNNING");
-                    if (memory[currentProcess->upperMemoryBound-4].value != NULL) {
-                        free(memory[currentProcess->upperMemoryBound-4].value);
-                    }
-                    memory[currentProcess->upperMemoryBound-4].value = strdup("RUNNING");
+                    pcbSetState(currentProcess, "RUNNING");
+                    memorySyncPCB(currentProcess);
                     
                     printf("Time %d: Process %d from Level %d is now running (Quantum: %d)\n", 
                         currentTime, currentProcess->processID, level + 1, remainingQuantum);
@@ -1329,25 +4485,20 @@ void run_mlfq_scheduler() {
             
             if (processIndex != -1) {
                 // Execute one instruction
-                int lastInstructionPosition = currentProcess->upperMemoryBound - 9;
+                int lastInstructionPosition = pcbInstructionCount(currentProcess) - 1;
                 if (currentProcess->programCounter <= lastInstructionPosition) {
-                    int memoryIndex = currentProcess->programCounter;
+                    int memoryIndex = pcbAddress(currentProcess, currentProcess->programCounter);
                     
                     printf("Time %d: Executing process %d, instruction: %s (Level: %d, Quantum remaining: %d)\n", 
-                        currentTime, currentProcess->processID, memory[memoryIndex].value, 
+                        currentTime, currentProcess->processID, memoryWordText(memoryIndex), 
                         currentLevel + 1, remainingQuantum);
                     
-                    execute(memory[memoryIndex].value, currentProcess);
+                    int executed = execute_instruction(&currentProcess->code[currentProcess->programCounter], currentProcess->operands, currentProcess);
                     
                     // Update program counter
-                    currentProcess->programCounter++;
+                    currentProcess->programCounter += executed;
                     // Update program counter in memory
-                    char tempBuffer[20];
-                    sprintf(tempBuffer, "%d", currentProcess->programCounter);
-                    if (memory[currentProcess->upperMemoryBound-2].value != NULL) {
-                        free(memory[currentProcess->upperMemoryBound-2].value);
-                    }
-                    memory[currentProcess->upperMemoryBound-2].value = strdup(tempBuffer);
+                    pcbMarkDirty(currentProcess, PCB_DIRTY_COUNTER);
                     
                     processTable[processIndex].executedTime++;
                     remainingQuantum--;
@@ -1357,10 +4508,7 @@ void run_mlfq_scheduler() {
                     if (strcmp(currentProcess->processState, "BLOCKED") == 0) {
                         printf("Time %d: Process %d was blocked, moving out of CPU\n",
                             currentTime, currentProcess->processID);
-                        if (memory[currentProcess->upperMemoryBound-4].value != NULL) {
-                            free(memory[currentProcess->upperMemoryBound-4].value);
-                        }
-                        memory[currentProcess->upperMemoryBound-4].value = strdup("BLOCKED");
+                        memorySyncPCB(currentProcess);
                         
                         // Save the current level and quantum in the process table
                         processTable[processIndex].currentQueueLevel = currentLevel;
@@ -1373,14 +4521,12 @@ void run_mlfq_scheduler() {
                     else if (currentProcess->programCounter > lastInstructionPosition) {
                         printf("Process %d has completed execution at time %d\n", 
                             currentProcess->processID, currentTime + 1);
-                        strcpy(currentProcess->processState, "TERMINATED");
-                        if (memory[currentProcess->upperMemoryBound-4].value != NULL) {
-                            free(memory[currentProcess->upperMemoryBound-4].value);
-                        }
-                        memory[currentProcess->upperMemoryBound-4].value = strdup("TERMINATED");
+                        pcbSetState(currentProcess, "TERMINATED");
+                        memorySyncPCB(currentProcess);
                         processTable[processIndex].isComplete = true;
-                        memorydeallocate(currentProcess->processID - 1); // Adjust for the off-by-one error
+                        memoryReleaseProcess(currentProcess);
                         free(currentProcess);
+                        processTable[processIndex].pcb = NULL;
                         currentProcess = NULL;
                     }
                     // Check if time quantum has expired
@@ -1389,11 +4535,8 @@ void run_mlfq_scheduler() {
                         if (currentLevel == NUM_MLFQ_LEVELS - 1) {
                             printf("Time %d: Process %d time quantum expired in Level 4 (RR), returning to queue\n", 
                                 currentTime + 1, currentProcess->processID);
-                            strcpy(currentProcess->processState, "READY");
-                            if (memory[currentProcess->upperMemoryBound-4].value != NULL) {
-                                free(memory[currentProcess->upperMemoryBound-4].value);
-                            }
-                            memory[currentProcess->upperMemoryBound-4].value = strdup("READY");
+                            pcbSetState(currentProcess, "READY");
+                            memorySyncPCB(currentProcess);
                             
                             // Reset quantum for RR
                             remainingQuantum = mlfqScheduler.timeQuantums[currentLevel];
@@ -1405,11 +4548,8 @@ void run_mlfq_scheduler() {
                             int newLevel = currentLevel + 1;
                             printf("Time %d: Process %d time quantum expired in Level %d, moving to Level %d\n", 
                                 currentTime + 1, currentProcess->processID, currentLevel + 1, newLevel + 1);
-                            strcpy(currentProcess->processState, "READY");
-                            if (memory[currentProcess->upperMemoryBound-4].value != NULL) {
-                                free(memory[currentProcess->upperMemoryBound-4].value);
-                            }
-                            memory[currentProcess->upperMemoryBound-4].value = strdup("READY");
+                            pcbSetState(currentProcess, "READY");
+                            memorySyncPCB(currentProcess);
                             
                             // Update process table with new level and reset quantum
                             processTable[processIndex].currentQueueLevel = newLevel;
@@ -1423,14 +4563,12 @@ void run_mlfq_scheduler() {
                     // Process completed all instructions but somehow we're still here
                     printf("Process %d has completed execution at time %d\n", 
                         currentProcess->processID, currentTime);
-                    strcpy(currentProcess->processState, "TERMINATED");
-                    if (memory[currentProcess->upperMemoryBound-4].value != NULL) {
-                        free(memory[currentProcess->upperMemoryBound-4].value);
-                    }
-                    memory[currentProcess->upperMemoryBound-4].value = strdup("TERMINATED");
+                    pcbSetState(currentProcess, "TERMINATED");
+                    memorySyncPCB(currentProcess);
                     processTable[processIndex].isComplete = true;
-                    memorydeallocate(currentProcess->processID - 1); // Adjust for the off-by-one error
+                    memoryReleaseProcess(currentProcess);
                     free(currentProcess);
+                    processTable[processIndex].pcb = NULL;
                     currentProcess = NULL;
                 }
             } else {
@@ -1500,24 +4638,27 @@ void run_fcfs_step() {
     // Check for new arrivals at current time
     printf("checking before process arrivals\n");
     check_for_process_arrivals(currentTime+1);
+    check_page_fault_completions();
+    check_disk_completions();
     printf("process arrivals checked\n");      
     // If no process is running, try to get one from the ready queue
     if (currentRunningProcess == NULL) {
         printf("dequeueing process\n");
         currentRunningProcess = dequeue(&readyQueue);
         printf("process dequeued\n");
+        if (currentRunningProcess != NULL && !memorySwapIn(currentRunningProcess)) {
+            enqueue(&readyQueue, currentRunningProcess);
+            currentRunningProcess = NULL;
+        }
         if (currentRunningProcess != NULL) {
             // Found a process to run
             printf("Found a process to run\n");
-            strcpy(currentRunningProcess->processState, "RUNNING");
+            pcbSetState(currentRunningProcess, "RUNNING");
             printf("Time %d: Process %d is now running\n", 
                   currentTime, currentRunningProcess->processID);
             printf("before updating memory\n");
             // Update process state in memory
-            if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                free(memory[currentRunningProcess->upperMemoryBound-4].value);
-            }
-            memory[currentRunningProcess->upperMemoryBound-4].value = strdup("RUNNING");
+            memorySyncPCB(currentRunningProcess);
             printf("after updating memory\n");
             // Find the process in the process table
             currentProcessIndex = -1;
@@ -1549,34 +4690,36 @@ void run_fcfs_step() {
     // At this point, we have a current running process
     if (currentProcessIndex != -1) {
         // Execute one instruction
-        int lastInstructionPosition = currentRunningProcess->upperMemoryBound - 9;
+        int lastInstructionPosition = pcbInstructionCount(currentRunningProcess) - 1;
         
         if (currentRunningProcess->programCounter <= lastInstructionPosition) {
-            int memoryIndex = currentRunningProcess->programCounter;
+            // Instruction pages are loaded on first use; a fault blocks the process
+            if (!memoryTouchPage(currentRunningProcess, currentRunningProcess->programCounter)) {
+                memoryPageFault(currentRunningProcess);
+                log_message(gui, "Page fault, moving process out of CPU");
+                currentRunningProcess = NULL;
+                return;
+            }
+            int memoryIndex = pcbAddress(currentRunningProcess, currentRunningProcess->programCounter);
             printf("getting the pc, before evaluating\n");  
             // Execute the instruction
             printf("Time %d: Executing process %d, instruction: %s\n",
-                  currentTime, currentRunningProcess->processID, memory[memoryIndex].value);
+                  currentTime, currentRunningProcess->processID, memoryWordText(memoryIndex));
             
             // Log the instruction being executed
             char message[200];
             snprintf(message, sizeof(message), "Time %d: Process %d executing: %s", 
-                    currentTime, currentRunningProcess->processID, memory[memoryIndex].value);
+                    currentTime, currentRunningProcess->processID, memoryWordText(memoryIndex));
             log_message(gui, message);
             
             // Actually execute the instruction
-            execute(memory[memoryIndex].value, currentRunningProcess);
+            int executed = execute_instruction(&currentRunningProcess->code[currentRunningProcess->programCounter], currentRunningProcess->operands, currentRunningProcess);
             printf("after executing the instruction\n");    
             // Update program counter
-            currentRunningProcess->programCounter++;
+            currentRunningProcess->programCounter += executed;
             
             // Update program counter in memory
-            char tempBuffer[20];
-            sprintf(tempBuffer, "%d", currentRunningProcess->programCounter);
-            if (memory[currentRunningProcess->upperMemoryBound-2].value != NULL) {
-                free(memory[currentRunningProcess->upperMemoryBound-2].value);
-            }
-            memory[currentRunningProcess->upperMemoryBound-2].value = strdup(tempBuffer);
+            pcbMarkDirty(currentRunningProcess, PCB_DIRTY_COUNTER);
             printf("after updating the pc in memory\n");
             // Update executed time for the process
             processTable[currentProcessIndex].executedTime++;
@@ -1594,6 +4737,7 @@ void run_fcfs_step() {
             if (strcmp(currentRunningProcess->processState, "BLOCKED") == 0) {
                 printf("Time %d: Process %d was blocked, moving out of CPU\n",
                       currentTime, currentRunningProcess->processID);
+                memorySyncPCB(currentRunningProcess);
                 log_message(gui, "Process blocked, moving out of CPU");
                 currentRunningProcess = NULL;
                 printf("after setting current running process to blocking\n");
@@ -1603,14 +4747,12 @@ void run_fcfs_step() {
                 printf("Process %d has completed execution at time %d\n", 
                       currentRunningProcess->processID, currentTime);
                 
-                strcpy(currentRunningProcess->processState, "TERMINATED");
-                if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                    free(memory[currentRunningProcess->upperMemoryBound-4].value);
-                }
-                memory[currentRunningProcess->upperMemoryBound-4].value = strdup("TERMINATED");
+                pcbSetState(currentRunningProcess, "TERMINATED");
+                memorySyncPCB(currentRunningProcess);
                 
-                // Mark process as complete in process table
+                // Mark process as complete in process table and release its memory
                 processTable[currentProcessIndex].isComplete = true;
+                memoryReleaseProcess(currentRunningProcess);
                 
                 // Log message about process completion
                 char message[100];
@@ -1628,22 +4770,25 @@ void run_fcfs_step() {
 
 // Execute a single step of Round Robin scheduling algorithm
 void run_rr_step() {
-    // Check for new arrivals
+    // Check for new arrivals and serviced page faults
     check_for_process_arrivals(currentTime);
+    check_page_fault_completions();
+    check_disk_completions();
     
     // If no process is running, try to get one from the ready queue
     if (currentRunningProcess == NULL) {
         currentRunningProcess = dequeue(&readyQueue);
+        if (currentRunningProcess != NULL && !memorySwapIn(currentRunningProcess)) {
+            enqueue(&readyQueue, currentRunningProcess);
+            currentRunningProcess = NULL;
+        }
         
         if (currentRunningProcess != NULL) {
-            strcpy(currentRunningProcess->processState, "RUNNING");
+            pcbSetState(currentRunningProcess, "RUNNING");
             printf("Time %d: Process %d is now running\n", 
                   currentTime, currentRunningProcess->processID);
             
-            if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                free(memory[currentRunningProcess->upperMemoryBound-4].value);
-            }
-            memory[currentRunningProcess->upperMemoryBound-4].value = strdup("RUNNING");
+            memorySyncPCB(currentRunningProcess);
             
             // Reset quantum for this process
             stepRemainingQuantum = RR_QUANTUM;
@@ -1678,36 +4823,38 @@ void run_rr_step() {
     // At this point, we have a current running process
     if (currentProcessIndex != -1) {
         // Calculate the position of the last instruction
-        int lastInstructionPosition = currentRunningProcess->upperMemoryBound - 9;
+        int lastInstructionPosition = pcbInstructionCount(currentRunningProcess) - 1;
         
         // Execute one instruction only if we haven't reached the end
         if (currentRunningProcess->programCounter <= lastInstructionPosition) {
-            int memoryIndex = currentRunningProcess->programCounter;
+            // Instruction pages are loaded on first use; a fault blocks the process
+            if (!memoryTouchPage(currentRunningProcess, currentRunningProcess->programCounter)) {
+                memoryPageFault(currentRunningProcess);
+                log_message(gui, "Page fault, moving process out of CPU");
+                currentRunningProcess = NULL;
+                return;
+            }
+            int memoryIndex = pcbAddress(currentRunningProcess, currentRunningProcess->programCounter);
             
             printf("Time %d: Executing process %d, instruction: %s (Quantum remaining: %d)\n", 
-                   currentTime, currentRunningProcess->processID, memory[memoryIndex].value, 
+                   currentTime, currentRunningProcess->processID, memoryWordText(memoryIndex), 
                    stepRemainingQuantum);
             
             // Log the instruction being executed
             char message[200];
             snprintf(message, sizeof(message), "Time %d: Process %d executing: %s (Quantum: %d)", 
-                    currentTime, currentRunningProcess->processID, memory[memoryIndex].value,
+                    currentTime, currentRunningProcess->processID, memoryWordText(memoryIndex),
                     stepRemainingQuantum);
             log_message(gui, message);
                     
             // Execute the instruction
-            execute(memory[memoryIndex].value, currentRunningProcess);
+            int executed = execute_instruction(&currentRunningProcess->code[currentRunningProcess->programCounter], currentRunningProcess->operands, currentRunningProcess);
             
             // Update program counter
-            currentRunningProcess->programCounter++;
+            currentRunningProcess->programCounter += executed;
             
             // Update program counter in memory
-            char tempBuffer[20];
-            sprintf(tempBuffer, "%d", currentRunningProcess->programCounter);
-            if (memory[currentRunningProcess->upperMemoryBound-2].value != NULL) {
-                free(memory[currentRunningProcess->upperMemoryBound-2].value);
-            }
-            memory[currentRunningProcess->upperMemoryBound-2].value = strdup(tempBuffer);
+            pcbMarkDirty(currentRunningProcess, PCB_DIRTY_COUNTER);
             
             // Update executed time for the process
             processTable[currentProcessIndex].executedTime++;
@@ -1728,6 +4875,7 @@ void run_rr_step() {
             if (strcmp(currentRunningProcess->processState, "BLOCKED") == 0) {
                 printf("Time %d: Process %d was blocked, moving out of CPU\n",
                        currentTime, currentRunningProcess->processID);
+                memorySyncPCB(currentRunningProcess);
                 log_message(gui, "Process blocked, moving out of CPU");
                 currentRunningProcess = NULL;
             }
@@ -1736,14 +4884,12 @@ void run_rr_step() {
                 printf("Process %d has completed execution at time %d\n", 
                        currentRunningProcess->processID, currentTime);
                 
-                strcpy(currentRunningProcess->processState, "TERMINATED");
-                if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                    free(memory[currentRunningProcess->upperMemoryBound-4].value);
-                }
-                memory[currentRunningProcess->upperMemoryBound-4].value = strdup("TERMINATED");
+                pcbSetState(currentRunningProcess, "TERMINATED");
+                memorySyncPCB(currentRunningProcess);
                 
-                // Mark process as complete in process table
+                // Mark process as complete in process table and release its memory
                 processTable[currentProcessIndex].isComplete = true;
+                memoryReleaseProcess(currentRunningProcess);
                 
                 // Log message about process completion
                 char message[100];
@@ -1759,11 +4905,8 @@ void run_rr_step() {
                 printf("Time %d: Process %d time quantum expired, moving to ready queue\n", 
                        currentTime, currentRunningProcess->processID);
                 
-                strcpy(currentRunningProcess->processState, "READY");
-                if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                    free(memory[currentRunningProcess->upperMemoryBound-4].value);
-                }
-                memory[currentRunningProcess->upperMemoryBound-4].value = strdup("READY");
+                pcbSetState(currentRunningProcess, "READY");
+                memorySyncPCB(currentRunningProcess);
                 
                 // Log message about quantum expiration
                 char message[100];
@@ -1989,19 +5132,22 @@ void run_rr_step() {
 void run_mlfq_step() {
     // Check if any new processes have arrived at the current time
     check_for_process_arrivals(currentTime);
+    check_page_fault_completions();
+    check_disk_completions();
     
     // If there's no current running process, find one from the highest priority non-empty queue
     if (currentRunningProcess == NULL) {
         for (int level = 0; level < NUM_MLFQ_LEVELS; level++) {
             currentRunningProcess = dequeue(&mlfqScheduler.queues[level]);
+            if (currentRunningProcess != NULL && !memorySwapIn(currentRunningProcess)) {
+                enqueue(&mlfqScheduler.queues[level], currentRunningProcess);
+                currentRunningProcess = NULL;
+            }
             if (currentRunningProcess != NULL) {
                 // Found a process to run
-                strcpy(currentRunningProcess->processState, "RUNNING");
+                pcbSetState(currentRunningProcess, "RUNNING");
                 
-                if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                    free(memory[currentRunningProcess->upperMemoryBound-4].value);
-                }
-                memory[currentRunningProcess->upperMemoryBound-4].value = strdup("RUNNING");
+                memorySyncPCB(currentRunningProcess);
                 
                 // Find the process in the process table
                 currentProcessIndex = -1;
@@ -2048,29 +5194,32 @@ void run_mlfq_step() {
     // Execute current process for one step if we have a running process
     if (currentRunningProcess != NULL && currentProcessIndex != -1) {
         // Execute one instruction
-        int lastInstructionPosition = currentRunningProcess->upperMemoryBound - 9;
+        int lastInstructionPosition = pcbInstructionCount(currentRunningProcess) - 1;
         if (currentRunningProcess->programCounter <= lastInstructionPosition) {
-            int memoryIndex = currentRunningProcess->programCounter;
+            // Instruction pages are loaded on first use; a fault blocks the process
+            if (!memoryTouchPage(currentRunningProcess, currentRunningProcess->programCounter)) {
+                memoryPageFault(currentRunningProcess);
+                log_message(gui, "Page fault, moving process out of CPU");
+                currentRunningProcess = NULL;
+                currentProcessIndex = -1;
+                return;
+            }
+            int memoryIndex = pcbAddress(currentRunningProcess, currentRunningProcess->programCounter);
             
             char message[256];
             snprintf(message, sizeof(message),
                     "Executing process %d, instruction: %s (Level: %d, Quantum remaining: %d)",
-                    currentRunningProcess->processID, memory[memoryIndex].value,
+                    currentRunningProcess->processID, memoryWordText(memoryIndex),
                     processTable[currentProcessIndex].currentQueueLevel + 1, stepRemainingQuantum);
                     log_message(gui,message);
             
-            execute(memory[memoryIndex].value, currentRunningProcess);
+            int executed = execute_instruction(&currentRunningProcess->code[currentRunningProcess->programCounter], currentRunningProcess->operands, currentRunningProcess);
             
             // Update program counter
-            currentRunningProcess->programCounter++;
+            currentRunningProcess->programCounter += executed;
             
             // Update program counter in memory
-            char tempBuffer[20];
-            sprintf(tempBuffer, "%d", currentRunningProcess->programCounter);
-            if (memory[currentRunningProcess->upperMemoryBound-2].value != NULL) {
-                free(memory[currentRunningProcess->upperMemoryBound-2].value);
-            }
-            memory[currentRunningProcess->upperMemoryBound-2].value = strdup(tempBuffer);
+            pcbMarkDirty(currentRunningProcess, PCB_DIRTY_COUNTER);
             
             processTable[currentProcessIndex].executedTime++;
             stepRemainingQuantum--;
@@ -2083,10 +5232,7 @@ void run_mlfq_step() {
                          currentRunningProcess->processID);
                          log_message(gui,message);
                 
-                if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                    free(memory[currentRunningProcess->upperMemoryBound-4].value);
-                }
-                memory[currentRunningProcess->upperMemoryBound-4].value = strdup("BLOCKED");
+                memorySyncPCB(currentRunningProcess);
                 
                 // The blocked process is already in the mutex's blocked queue
                 // Reset for next process selection
@@ -2100,15 +5246,13 @@ void run_mlfq_step() {
                          currentRunningProcess->processID);
                          log_message(gui,message);
                 
-                strcpy(currentRunningProcess->processState, "TERMINATED");
-                if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                    free(memory[currentRunningProcess->upperMemoryBound-4].value);
-                }
-                memory[currentRunningProcess->upperMemoryBound-4].value = strdup("TERMINATED");
+                pcbSetState(currentRunningProcess, "TERMINATED");
+                memorySyncPCB(currentRunningProcess);
                 
                 processTable[currentProcessIndex].isComplete = true;
-                memorydeallocate(currentRunningProcess->processID - 1);
+                memoryReleaseProcess(currentRunningProcess);
                 free(currentRunningProcess);
+                processTable[currentProcessIndex].pcb = NULL;
                 currentRunningProcess = NULL;
                 currentProcessIndex = -1;
             }
@@ -2123,11 +5267,8 @@ void run_mlfq_step() {
                              currentRunningProcess->processID, currentLevel + 1);
                              log_message(gui,message);
                     
-                    strcpy(currentRunningProcess->processState, "READY");
-                    if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                        free(memory[currentRunningProcess->upperMemoryBound-4].value);
-                    }
-                    memory[currentRunningProcess->upperMemoryBound-4].value = strdup("READY");
+                    pcbSetState(currentRunningProcess, "READY");
+                    memorySyncPCB(currentRunningProcess);
                     
                     // Reset quantum for RR at this level
                     stepRemainingQuantum = mlfqScheduler.timeQuantums[currentLevel];
@@ -2144,11 +5285,8 @@ void run_mlfq_step() {
                              currentRunningProcess->processID, currentLevel + 1, newLevel + 1);
                              log_message(gui,message);
                     
-                    strcpy(currentRunningProcess->processState, "READY");
-                    if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                        free(memory[currentRunningProcess->upperMemoryBound-4].value);
-                    }
-                    memory[currentRunningProcess->upperMemoryBound-4].value = strdup("READY");
+                    pcbSetState(currentRunningProcess, "READY");
+                    memorySyncPCB(currentRunningProcess);
                     
                     // Update process table with new level and reset quantum
                     processTable[currentProcessIndex].currentQueueLevel = newLevel;
@@ -2171,15 +5309,13 @@ void run_mlfq_step() {
                      currentRunningProcess->processID);
                      log_message(gui,message);
             
-            strcpy(currentRunningProcess->processState, "TERMINATED");
-            if (memory[currentRunningProcess->upperMemoryBound-4].value != NULL) {
-                free(memory[currentRunningProcess->upperMemoryBound-4].value);
-            }
-            memory[currentRunningProcess->upperMemoryBound-4].value = strdup("TERMINATED");
+            pcbSetState(currentRunningProcess, "TERMINATED");
+            memorySyncPCB(currentRunningProcess);
             
             processTable[currentProcessIndex].isComplete = true;
-            memorydeallocate(currentRunningProcess->processID - 1);
+            memoryReleaseProcess(currentRunningProcess);
             free(currentRunningProcess);
+            processTable[currentProcessIndex].pcb = NULL;
             currentRunningProcess = NULL;
             currentProcessIndex = -1;
         }
@@ -2230,6 +5366,8 @@ int execute_step() {
 
     // Check if all processes are complete
     if (all_processes_complete()) {
+        writeBehindFlush();
+        fileSystemExport();
         return 0;  // Simulation complete
     }
    
@@ -2245,6 +5383,7 @@ int execute_step() {
             run_mlfq_step();
             break;
     }
+    writeBehindTick();
     
     // Update GUI to show the state at current time
     if (gui) {
@@ -2291,29 +5430,23 @@ void reset_scheduler() {
     if (processTable != NULL) {
         for (int i = 0; i < numProcesses; i++) {
             if (processTable[i].pcb != NULL) {
+                memoryReleaseProcess(processTable[i].pcb);
                 free(processTable[i].pcb);
                 processTable[i].pcb = NULL;
             }
         }
         free(processTable);
         processTable = NULL;
+        processTableCapacity = 0;
     }
-    for (int i = 0; i < memorySize; i++) {
-        if (memory[i].name != NULL) {
-            free(memory[i].name);
-            memory[i].name = NULL;
-        }
-        if (memory[i].value != NULL) {
-            free(memory[i].value);
-            memory[i].value = NULL;
-        }
-        memory[i].processID = -1;
-    }
+    memoryClear();
+    writeBehindFlush();
+    diskReset();
     
     numProcesses = 0;
 
     // Reset variables
-    var_count = 0;
+    variableScopeFree(&looseVariables);
     
     // Re-initialize the simulation
     initialize_simulation();
@@ -2358,32 +5491,26 @@ void reset_simulation() {
     if (processTable != NULL) {
         for (int i = 0; i < numProcesses; i++) {
             if (processTable[i].pcb != NULL) {
+                memoryReleaseProcess(processTable[i].pcb);
                 free(processTable[i].pcb);
                 processTable[i].pcb = NULL;
             }
         }
         free(processTable);
         processTable = NULL;
+        processTableCapacity = 0;
     }
     
     // Reset memory
-    for (int i = 0; i < memorySize; i++) {
-        if (memory[i].name != NULL) {
-            free(memory[i].name);
-            memory[i].name = NULL;
-        }
-        if (memory[i].value != NULL) {
-            free(memory[i].value);
-            memory[i].value = NULL;
-        }
-        memory[i].processID = -1;
-    }
+    memoryClear();
+    writeBehindFlush();
+    diskReset();
     
     // Reset variables
     numProcesses = 0;
     currentTime = -1;
     processCount = 0;
-    var_count = 0;
+    variableScopeFree(&looseVariables);
     simulationRunning = false;
     simulationPaused = false;
     currentRunningProcess = NULL;
@@ -2397,21 +5524,23 @@ void cleanupResources() {
     if (processTable != NULL) {
         for (int i = 0; i < numProcesses; i++) {
             if (processTable[i].pcb != NULL) {
+                memoryReleaseProcess(processTable[i].pcb);
                 free(processTable[i].pcb);
             }
         }
         free(processTable);
+        processTable = NULL;
+        processTableCapacity = 0;
     }
     
+    writeBehindFlush();
+    fileSystemExport();
+    fileSystemClear();
+    diskReset();
+
     // Free memory words
-    for (int i = 0; i < memorySize; i++) {
-        if (memory[i].name != NULL) {
-            free(memory[i].name);
-        }
-        if (memory[i].value != NULL) {
-            free(memory[i].value);
-        }
-    }
+    memoryClear();
+    programCacheClear();
     
     printf("Resources cleaned up\n");
     log_message(gui, "Resources cleaned up\n");
@@ -2421,9 +5550,9 @@ void cleanupResources() {
 
 // Get scheduler statistics as a string
 char* get_scheduler_stats_string() {
-    static char stats[256];
+    static char stats[2048];
     
-    int total = 0, ready = 0, running = 0, blocked = 0, completed = 0;
+    int total = 0, ready = 0, running = 0, blocked = 0, ioWait = 0, completed = 0;
     
     for (int i = 0; i < numProcesses; i++) {
         total++;
@@ -2434,6 +5563,8 @@ char* get_scheduler_stats_string() {
                 ready++;
             } else if (strcmp(processTable[i].pcb->processState, "RUNNING") == 0) {
                 running++;
+            } else if (processTable[i].pcb->waitingForDisk) {
+                ioWait++;
             } else if (strcmp(processTable[i].pcb->processState, "BLOCKED") == 0) {
                 blocked++;
             }
@@ -2448,12 +5579,66 @@ char* get_scheduler_stats_string() {
         default: algoName = "Unknown";
     }
     
-    sprintf(stats, "Time: %d\nAlgorithm: %s\nProcesses: %d (Ready: %d, Running: %d, Blocked: %d, Completed: %d)",
-            currentTime, algoName, total, ready, running, blocked, completed);
+    snprintf(stats, sizeof(stats), "Time: %d\nAlgorithm: %s\nProcesses: %d (Ready: %d, Running: %d, Blocked: %d, I/O wait: %d, Completed: %d)\nSwap: %s\nPlacement: %s\nProgram cache: %s\nDispatch: %s\nFile I/O: %s\nDisk: %s\nDisk latency: %s",
+            currentTime, algoName, total, ready, running, blocked, ioWait, completed, get_swap_stats_string(),
+            get_placement_stats_string(), get_program_cache_stats_string(), get_dispatch_stats_string(),
+            get_file_io_stats_string(), get_disk_stats_string(), get_disk_latency_string());
             
     return stats;
 }
 
+// Swap counters, bytes moved and average wall-clock latency per transfer
+char* get_swap_stats_string() {
+    static char stats[200];
+    snprintf(stats, sizeof(stats), "%d out (%lld KB, %lld us avg), %d in (%lld KB, %lld us avg), %lld cycles",
+             swapStats.swapOuts, swapStats.bytesOut / 1024,
+             swapStats.swapOuts ? swapStats.swapOutNanos / swapStats.swapOuts / 1000 : 0,
+             swapStats.swapIns, swapStats.bytesIn / 1024,
+             swapStats.swapIns ? swapStats.swapInNanos / swapStats.swapIns / 1000 : 0,
+             swapStats.cycles);
+    return stats;
+}
+
+// Placement policy, its counters and the current external fragmentation
+char* get_placement_stats_string() {
+    static char stats[240];
+    static const char* names[] = {"first-fit", "next-fit", "best-fit", "worst-fit", "buddy"};
+    if (pagedMemory) {
+        snprintf(stats, sizeof(stats), "paged, %d of %d frames free", memoryFreeWords >> pageShift, frameCount);
+        return stats;
+    }
+    long long requests = placementStats.allocations + placementStats.failures;
+    int largest = memoryLargestFreeBlock();
+    double external = memoryFreeWords ? 100.0 * (memoryFreeWords - largest) / memoryFreeWords : 0.0;
+    snprintf(stats, sizeof(stats),
+             "%s, %lld placed, %lld failed, %.1f blocks searched avg, largest free %d of %d words (%.0f%% external), %lld words rounded up",
+             names[placementPolicy], placementStats.allocations, placementStats.failures,
+             requests ? (double)placementStats.blocksSearched / requests : 0.0,
+             largest, memoryFreeWords, external, placementStats.wastedWords);
+    return stats;
+}
+
+// Program cache hits and misses, and what shared text saves
+char* get_program_cache_stats_string() {
+    static char stats[200];
+    long long lookups = programCacheStats.hits + programCacheStats.misses;
+    snprintf(stats, sizeof(stats), "%d programs, %lld hits, %lld misses (%lld reloaded), %.0f%% hit rate, %d shared texts saving %d words",
+             programCacheCount, programCacheStats.hits, programCacheStats.misses, programCacheStats.reloads,
+             lookups ? 100.0 * programCacheStats.hits / lookups : 0.0,
+             textSegmentCount, text_segment_words_saved());
+    return stats;
+}
+
+// Fault rate, resident set and evictions of one process
+char* get_paging_stats_string(PCB* process) {
+    static char stats[160];
+    double faultRate = process->pageReferences ? 100.0 * process->pageFaults / process->pageReferences : 0.0;
+    snprintf(stats, sizeof(stats), "%d faults / %d fetches (%.1f%%), RSS %d pages (peak %d), %d evicted",
+             process->pageFaults, process->pageReferences, faultRate,
+             process->residentPages, process->peakResidentPages, process->pageEvictions);
+    return stats;
+}
+
 // Get process state as a string
 char* get_process_state_string(PCB* process) {
     if (process == NULL) {
@@ -2485,8 +5670,11 @@ char* get_current_instruction(PCB* process) {
         return "No process running";
     }
     
-    if (process->programCounter <= process->upperMemoryBound - 9) {
-        sprintf(instruction, "%s", memory[process->programCounter].value);
+    if (process->programCounter < pcbInstructionCount(process)) {
+        if (!process->resident || !pcbPageLoaded(process, process->programCounter)) {
+            return "Page not loaded";
+        }
+        sprintf(instruction, "%s", memoryWordText(pcbAddress(process, process->programCounter)));
         return instruction;
     }
     
@@ -2560,20 +5748,11 @@ int add_process(const char *filepath, int arrival_time) {
         return -1;
     }
 
-    if (numProcesses >= MAX_PROCESSES) {
-        fprintf(stderr, "Process table full\n");
-        log_message(gui, "Process table full\n");
-        return 0;
-    }
-
-    // Allocate process table if needed
-    if (processTable == NULL) {
-        processTable = (ProcessTableEntry*)malloc(MAX_PROCESSES * sizeof(ProcessTableEntry));
-        if (!processTable) {
-            fprintf(stderr, "Failed to allocate process table\n");
-            log_message(gui, "Failed to allocate process table\n");
-            return -1;
-        }
+    // Grow the process table if needed
+    if (!ensure_process_table_capacity(numProcesses + 1)) {
+        fprintf(stderr, "Failed to allocate process table\n");
+        log_message(gui, "Failed to allocate process table\n");
+        return -1;
     }
 
     int index = numProcesses;
@@ -2625,6 +5804,7 @@ void run_full_simulation() {
                 run_mlfq_step();
                 break;
         }
+        writeBehindTick();
         
         // Check if we're waiting for input
         if (waiting_for_input) {
@@ -2640,7 +5820,98 @@ void run_full_simulation() {
         sleep(1);
     }
     
+    writeBehindFlush();
+    fileSystemExport();
     printf("Full simulation complete at time %d\n", currentTime);
+    printf("Swap: %s\n", get_swap_stats_string());
+    printf("Placement: %s\n", get_placement_stats_string());
+    printf("Program cache: %s\n", get_program_cache_stats_string());
+    printf("Dispatch: %s\n", get_dispatch_stats_string());
+    printf("File I/O: %s\n", get_file_io_stats_string());
+    printf("Disk: %s\n", get_disk_stats_string());
+    printf("Disk latency: %s\n", get_disk_latency_string());
 }
 
-
+// Consume simulator options (e.g. --memory-size=N) from the command line,
+// leaving the remaining arguments for GTK
+void parse_simulator_options(int *argc, char **argv) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strncmp(argv[i], "--memory-size=", 14) == 0) {
+            set_memory_size(atoi(argv[i] + 14));
+        } else if (strcmp(argv[i], "--placement=first-fit") == 0) {
+            set_placement_policy(PLACE_FIRST_FIT);
+        } else if (strcmp(argv[i], "--placement=next-fit") == 0) {
+            set_placement_policy(PLACE_NEXT_FIT);
+        } else if (strcmp(argv[i], "--placement=best-fit") == 0) {
+            set_placement_policy(PLACE_BEST_FIT);
+        } else if (strcmp(argv[i], "--placement=worst-fit") == 0) {
+            set_placement_policy(PLACE_WORST_FIT);
+        } else if (strcmp(argv[i], "--placement=buddy") == 0) {
+            set_placement_policy(PLACE_BUDDY);
+        } else if (strncmp(argv[i], "--page-size=", 12) == 0) {
+            set_page_size(atoi(argv[i] + 12));
+        } else if (strcmp(argv[i], "--demand-paging") == 0) {
+            if (!pagedMemory) set_page_size(pageSize);
+            demandPaging = true;
+        } else if (strcmp(argv[i], "--page-replacement=fifo") == 0) {
+            pageReplacement = REPLACE_FIFO;
+        } else if (strcmp(argv[i], "--page-replacement=lru") == 0) {
+            pageReplacement = REPLACE_LRU;
+        } else if (strcmp(argv[i], "--page-replacement=clock") == 0) {
+            pageReplacement = REPLACE_CLOCK;
+        } else if (strcmp(argv[i], "--page-replacement=working-set") == 0) {
+            pageReplacement = REPLACE_WORKING_SET;
+        } else if (strncmp(argv[i], "--page-fault-cycles=", 20) == 0) {
+            pageFaultCycles = atoi(argv[i] + 20);
+        } else if (strncmp(argv[i], "--working-set-window=", 21) == 0) {
+            workingSetWindow = atoi(argv[i] + 21);
+        } else if (strcmp(argv[i], "--no-shared-text") == 0) {
+            shareText = false;
+        } else if (strcmp(argv[i], "--fuse-critical-sections") == 0) {
+            fuseCriticalSections = true;
+        } else if (strncmp(argv[i], "--write-behind-bytes=", 21) == 0) {
+            writeBehindBytes = (size_t)atol(argv[i] + 21);
+        } else if (strncmp(argv[i], "--write-behind-age=", 19) == 0) {
+            writeBehindAge = atoi(argv[i] + 19);
+        } else if (strcmp(argv[i], "--fsync") == 0) {
+            syncWrites = true;
+        } else if (strcmp(argv[i], "--disk-io") == 0) {
+            diskIO = true;
+        } else if (strncmp(argv[i], "--disk-latency=", 15) == 0) {
+            diskLatency = atoi(argv[i] + 15);
+        } else if (strncmp(argv[i], "--disk-bandwidth=", 17) == 0) {
+            diskBandwidth = atoi(argv[i] + 17) > 0 ? atoi(argv[i] + 17) : 1;
+        } else if (strncmp(argv[i], "--disk-cylinders=", 17) == 0) {
+            diskCylinders = atoi(argv[i] + 17) > 0 ? atoi(argv[i] + 17) : 1;
+        } else if (strncmp(argv[i], "--disk-seek-rate=", 17) == 0) {
+            diskSeekRate = atoi(argv[i] + 17) > 0 ? atoi(argv[i] + 17) : 1;
+        } else if (strcmp(argv[i], "--disk-scheduler=fcfs") == 0) {
+            diskScheduling = DISK_FCFS;
+        } else if (strcmp(argv[i], "--disk-scheduler=sstf") == 0) {
+            diskScheduling = DISK_SSTF;
+        } else if (strcmp(argv[i], "--disk-scheduler=scan") == 0) {
+            diskScheduling = DISK_SCAN;
+        } else if (strcmp(argv[i], "--disk-scheduler=c-look") == 0) {
+            diskScheduling = DISK_CLOOK;
+        } else if (strcmp(argv[i], "--simulated-fs") == 0) {
+            simulatedFS = true;
+        } else if (strncmp(argv[i], "--simulated-fs=", 15) == 0) {
+            fileSystemImport(argv[i] + 15);
+        } else if (strcmp(argv[i], "--write-through") == 0) {
+            pcbWriteBack = false;
+        } else if (strncmp(argv[i], "--swap-file=", 12) == 0) {
+            snprintf(swapFileName, sizeof(swapFileName), "%s", argv[i] + 12);
+        } else if (strcmp(argv[i], "--swap-policy=none") == 0) {
+            swapPolicy = SWAP_NONE;
+        } else if (strcmp(argv[i], "--swap-policy=oldest-blocked") == 0) {
+            swapPolicy = SWAP_OLDEST_BLOCKED;
+        } else if (strcmp(argv[i], "--swap-policy=lowest-level") == 0) {
+            swapPolicy = SWAP_LOWEST_LEVEL;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argv[kept] = NULL;
+    *argc = kept;
+}
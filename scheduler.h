@@ -1,6 +1,7 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include "GUI.h"
@@ -9,40 +10,340 @@
 
 
 // Define constants
-#define MAX_PROCESSES 10
+#define PROCESS_TABLE_INITIAL_SIZE 10   // the process table grows as processes are added
+#define MIN_MEMORY_SIZE 60
+#define MAX_MEMORY_SIZE (64 * 1024 * 1024)
+#define PROCESS_IMAGE_OVERHEAD 9        // 3 variable words + 6 PCB words after the instructions
+#define COMPACTION_WORDS_PER_CYCLE 16   // words compaction can move per clock cycle
+#define SWAP_WORDS_PER_CYCLE 8          // words the swap device can transfer per clock cycle
+#define DEFAULT_SWAP_FILE "scheduler.swap"
+#define MAX_PAGE_SIZE 4096              // page size in words; must be a power of two
 #define MAX_PRIORITY 3  
-#define MAX_VARIABLES 100
+#define PROCESS_VARIABLE_WORDS 3
 #define MAX_LINE_LENGTH 256
 #define MAX_FILENAME_LENGTH 50
 #define MAX_CONTENT_LENGTH 1024
+#define ROPE_CHUNK_SIZE (64 * 1024)   // bytes per rope chunk
 #define MAX_INSTRUCTIONS 20
 #define INSTRUCTION_SIZE 50
 #define STATE_SIZE 20
 #define NUM_MLFQ_LEVELS 4  // 4 levels for MLFQ
 
 
+// PCB fields mirrored in memory that may be out of date (see pcbWriteBack)
+#define PCB_DIRTY_STATE   0x1
+#define PCB_DIRTY_COUNTER 0x2
+
+// Bump allocator holding a process's line table, plus the private mapping of
+// its program file that the lines point into; both go when the process ends
+typedef struct {
+    char* base;
+    size_t size;
+    size_t used;
+    char* mapping;
+    size_t mappingSize;
+} ProcessArena;
+
+// Immutable text kept in fixed-size chunks and shared by reference between
+// variables, memory words and writeFile (file contents)
+typedef struct Rope {
+    int refCount;
+    size_t length;
+    int chunkCount;
+    char** chunks;            // ROPE_CHUNK_SIZE bytes each, the last may be shorter
+    char* flat;               // contiguous copy, made the first time one is needed
+} Rope;
+
+typedef enum {
+    VALUE_NONE = 0,           // never assigned
+    VALUE_INT,                // data.number, for canonical integers ("42", "-7")
+    VALUE_INLINE,             // short string in data.text
+    VALUE_SHARED,             // longer string in data.shared
+    VALUE_ROPE                // file contents in data.rope
+} ValueKind;
+
+#define VALUE_INLINE_SIZE 16
+
+// Immutable string shared by every variable holding it
+typedef struct {
+    int refCount;
+    size_t length;
+    char text[];
+} SharedString;
+
+// A variable's value; copying one only bumps a reference count
+typedef struct {
+    uint8_t kind;             // ValueKind
+    union {
+        int64_t number;
+        char text[VALUE_INLINE_SIZE];
+        SharedString* shared;
+        Rope* rope;
+    } data;
+} Value;
+
+typedef struct {
+    uint16_t nameID;          // interned name
+    Value value;
+} Variable;
+
+// One process's variables. The program's names take the first slots, in
+// the order its decoded instructions refer to them; names met only at run
+// time are appended. The hash maps a nameID to its slot.
+typedef struct {
+    Variable* slots;
+    int count;
+    int capacity;
+    uint16_t* hash;           // slot + 1, 0 = empty; open addressing
+    int hashSize;
+} VariableScope;
+
+// A parsed program file, kept so later arrivals of it skip the file entirely
+typedef struct {
+    char* path;               // canonical path
+    unsigned long long device;
+    unsigned long long inode;
+    long long mtimeNanos;     // modification time the text was read at
+    char* text;               // the lines, each terminated
+    size_t textBytes;
+    size_t* offsets;          // start of each line in text
+    struct Instruction* code; // each line decoded
+    char* operands;           // operand strings the decoded lines refer to
+    size_t operandBytes;
+    uint16_t* symbols;        // interned names the decoded code binds, by slot
+    int symbolCount;
+    int lines;
+    int id;                   // never reused, so text segments can refer to it
+} ProgramCacheEntry;
+
+// Names a program's code refers to, collected while it is decoded
+typedef struct {
+    VariableScope names;      // slot order is the order the code binds them
+    int16_t assigned[PROCESS_VARIABLE_WORDS]; // slots given process variable words, in order
+    int assignedCount;
+} ProgramSymbols;
+
+typedef struct {
+    long long hits;
+    long long misses;
+    long long reloads;        // misses caused by a cached file having changed
+} ProgramCacheStats;
+
+// Instructions of one program, shared read-only by every process running it.
+// Their memory words belong to no single process and carry this owner id.
+#define TEXT_OWNER_ID -2
+
+typedef struct {
+    int programID;            // program cache entry the text was loaded from
+    int start;                // first memory word
+    int length;               // instructions
+    int regionLength;         // words taken, which the buddy allocator rounds up
+    int refCount;             // live processes using the segment
+} TextSegment;
+
 typedef struct PCB {
     int processID;
     char processState[50];
     int currentPriority; 
-    int programCounter;
-    int lowerMemoryBound;                         
+    int programCounter;       // offset into the process image (see pcbAddress)
+    int lowerMemoryBound;     // base register of the private words; moves when memory is compacted (0 when paged)
     int upperMemoryBound;
+    int* pageTable;           // frame holding each page of the image, -1 if not loaded (paged mode only)
+    int pageCount;
+    char** programText;       // program lines, the backing store for instruction pages
+    int programLines;
+    ProcessArena arena;       // owns programText and its lines
+    TextSegment* text;        // shared instructions; NULL if the image holds its own
+    const struct Instruction* code; // decoded programText, in the arena
+    const char* operands;     // operand strings of the decoded instructions
+    VariableScope variables;
+    int wakeTime;             // time a page fault completes
+    int pageReferences;       // instruction fetches, for the fault rate
+    int pageFaults;
+    int pageEvictions;        // pages of this process evicted by page replacement
+    int residentPages;
+    int peakResidentPages;
+    unsigned int dirtyFields; // PCB_DIRTY_* fields not yet written to memory
+    int blockedSince;         // time the process last blocked
+    bool resident;            // false while the image is in the swap file
+    int swapStart;            // first swap block of the image when not resident
+    int swapBlocks;
+    int swapWords;            // memory words the image needs when swapped back in
+    bool waitingForDisk;      // BLOCKED in I/O wait rather than on a mutex or page fault
     struct PCB* next; // points to the next process in the queue
 } PCB;
 
+// Fixed ids of interned memory word names (other names are interned on use)
+enum {
+    NAME_NONE = 0,
+    NAME_INSTRUCTION,
+    NAME_VARIABLE,
+    NAME_PCB_ID,
+    NAME_PROCESS_STATE,
+    NAME_CURRENT_PRIORITY,
+    NAME_PROGRAM_COUNTER,
+    NAME_LOWER_MEMORY_BOUND,
+    NAME_UPPER_MEMORY_BOUND,
+    NAME_FIRST_DYNAMIC
+};
+
+// What a memory word's value holds
+typedef enum {
+    WORD_EMPTY = 0,
+    WORD_INT,       // value.number
+    WORD_INLINE,    // short string in value.text
+    WORD_HEAP,      // longer string in value.heap
+    WORD_TEXT,      // longer string in value.heap, owned by the process arena
+    WORD_ROPE       // a reference to value.rope
+} memoryWordKind;
+
+#define WORD_INLINE_SIZE 16
+
 typedef struct {
-    int processID;
-    char* name;
-    char* value; 
+    int32_t processID;
+    uint16_t nameID;     // interned name, NAME_NONE if the word is free
+    uint16_t nameIndex;  // suffix of indexed names ("Instruction 3")
+    uint8_t kind;        // memoryWordKind
+    union {
+        int64_t number;
+        char text[WORD_INLINE_SIZE];
+        char* heap;
+        Rope* rope;
+    } value;
 } memoryWord;
 
+_Static_assert(sizeof(memoryWord) <= 32, "memoryWord should stay within 32 bytes");
+
 
+// Free run of memory words, kept sorted by start address
 typedef struct {
-    char name[50];
-    char value[1000];
-    int is_numeric; // 1 if number, 0 if string
-} Variable;
+    int start;
+    int length;
+} memoryExtent;
+
+// Memory words owned by a process (length 0 if none)
+typedef struct {
+    int start;
+    int length;
+} memoryRegion;
+
+// Where a contiguous process image is placed in memory
+typedef enum {
+    PLACE_FIRST_FIT,        // the lowest free extent that fits
+    PLACE_NEXT_FIT,         // the first extent that fits after the previous placement
+    PLACE_BEST_FIT,         // the smallest extent that fits
+    PLACE_WORST_FIT,        // the largest extent
+    PLACE_BUDDY             // power-of-two blocks, split and coalesced in buddy pairs
+} PlacementPolicy;
+
+typedef struct {
+    long long allocations;
+    long long failures;         // requests no free block could hold
+    long long blocksSearched;   // free extents (or buddy orders) examined
+    long long wastedWords;      // words handed out beyond the request (buddy rounding)
+} PlacementStats;
+
+// How demand paging picks the page to evict
+typedef enum {
+    REPLACE_FIFO,           // the page loaded first
+    REPLACE_LRU,            // the page referenced least recently
+    REPLACE_CLOCK,          // second chance using a reference bit
+    REPLACE_WORKING_SET     // a page outside the owner's working set, else LRU
+} PageReplacementPolicy;
+
+// One memory frame in paged mode
+typedef struct {
+    int owner;              // process ID, -1 if free
+    int page;               // page of the owner held here
+    PCB* process;
+    long long loadedAt;     // load order (FIFO)
+    long long lastUse;      // reference order (LRU)
+    int lastUseTime;        // time of the last reference (working set)
+    bool referenced;        // reference bit (Clock)
+    bool pinned;            // holds variables or PCB words; never evicted
+} pageFrame;
+
+// Which resident process the medium-term scheduler swaps out first
+typedef enum {
+    SWAP_NONE,              // never swap; arrivals wait for free memory
+    SWAP_OLDEST_BLOCKED,    // the process blocked the longest, then the lowest MLFQ level
+    SWAP_LOWEST_LEVEL       // the process in the lowest MLFQ level, blocked ones first
+} SwapPolicy;
+
+typedef struct {
+    int swapOuts;
+    int swapIns;
+    long long bytesOut;
+    long long bytesIn;
+    long long swapOutNanos;   // wall-clock time spent copying to the swap file
+    long long swapInNanos;
+    long long cycles;         // simulated clock cycles charged for swapping
+} SwapStats;
+
+typedef struct {
+    long long reads;          // readFile instructions that found their file
+    long long bytesRead;
+    long long readCycles;     // simulated cycles those reads took, disk time with --disk-io
+    long long readNanos;      // wall-clock time spent streaming them out
+    long long writes;         // writeFile instructions accepted
+    long long writesCoalesced;// writes that replaced one still pending
+    long long writeErrors;    // opens, writes, syncs or closes that failed
+    long long bytesWritten;   // bytes that reached the host file system
+    long long writeBatches;   // write-behind flushes
+    long long fsyncs;
+} FileIOStats;
+
+#define WRITE_BEHIND_FILES 64
+
+// How the disk picks the next queued request
+typedef enum {
+    DISK_FCFS,              // arrival order
+    DISK_SSTF,              // the shortest seek from the head
+    DISK_SCAN,              // sweep to the last cylinder and back (elevator)
+    DISK_CLOOK              // sweep upwards only, then jump to the lowest request
+} DiskSchedulingPolicy;
+
+#define DISK_LATENCY_BUCKETS 8    // 0-1, 2-3, 4-7, ... 128+ time units
+
+// A readFile or writeFile transfer waiting for, or being served by, the disk
+typedef struct DiskRequest {
+    PCB* process;
+    bool write;
+    long long bytes;
+    int cylinder;
+    int issuedAt;             // time the instruction ran
+    int doneAt;               // completion time, set when the disk starts it
+    struct DiskRequest* next;
+} DiskRequest;
+
+typedef struct {
+    long long requests;
+    long long bytes;
+    long long busyCycles;     // time units the disk spent on transfers
+    long long waitCycles;     // issue to completion, summed over requests
+    long long completed;
+    long long seekDistance;   // cylinders the head has travelled
+    long long queueDepthSum;  // requests already queued, summed over arrivals
+    int maxQueue;             // longest the request queue has been
+    long long latency[DISK_LATENCY_BUCKETS];   // completed requests by issue-to-completion time
+} DiskStats;
+
+#define FS_BLOCK_SIZE 4096    // divides ROPE_CHUNK_SIZE
+
+// A file of the simulated file system; contents live in pooled blocks
+typedef struct {
+    char* name;
+    size_t length;
+    int* blocks;              // block numbers in file order
+    int blockCount;
+    int blockCapacity;
+} SimInode;
+
+typedef struct {
+    char* path;               // file name as the program gave it
+    Value content;            // what the file will hold once flushed
+    int queuedAt;             // time of the oldest write still pending
+} PendingWrite;
 
 // Queue node for scheduling
 typedef struct QueueNode {
@@ -86,6 +387,49 @@ typedef struct {
 } Mutex;
 // Forward declarations for types
 
+// Instruction kinds, decided once when a program is loaded
+typedef enum {
+    OP_INVALID,             // unknown command or wrong operand count; arg1 is the command
+    OP_PRINT,
+    OP_ASSIGN,              // arg1 = arg2, a number or a variable
+    OP_ASSIGN_NUMBER,       // arg1 = number, the canonical integer literal arg2
+    OP_ASSIGN_INPUT,        // arg1 = what the user types
+    OP_ASSIGN_READ_FILE,    // arg1 = contents of the file arg2
+    OP_PRINT_FROM_TO,
+    OP_WRITE_FILE,
+    OP_READ_FILE,
+    OP_SEM_WAIT,
+    OP_SEM_SIGNAL,
+    OP_CRITICAL_SECTION,    // semWait arg; op; semSignal arg, fused when the program is loaded
+    OP_COUNT
+} Opcode;
+
+// A decoded instruction. Operands are offsets into the program's operand
+// strings, so decoded programs can be copied without fixing up pointers.
+typedef struct Instruction {
+    uint8_t opcode;         // Opcode
+    int8_t slot;            // process variable word written by assign, -1 = search by name
+    int16_t var1;           // variable scope slot of each operand, -1 = look up by name
+    int16_t var2;
+    uint32_t arg1;
+    uint32_t arg2;
+    union {
+        Mutex* mutex;       // semWait/semSignal target; NULL for an unknown resource
+        int64_t number;     // OP_ASSIGN_NUMBER literal
+    };
+} Instruction;
+
+// Runs one decoded instruction and returns how many it covered (a fused
+// critical section covers three)
+typedef int (*InstructionHandler)(const Instruction* ins, const char* operands, PCB* process);
+
+typedef struct {
+    long long instructions;   // program instructions executed
+    long long dispatches;     // handler calls that executed them
+    long long fusedSections;  // critical sections run as one step
+    long long hostNanos;      // host time spent running them
+} DispatchStats;
+
 
 // Scheduling algorithm enum
 typedef enum {
@@ -96,15 +440,50 @@ typedef enum {
 
 extern memoryWord *memory;
 extern int memorySize;
+extern bool pcbWriteBack;
+extern uint64_t *memoryBitmap;
+extern memoryExtent *freeExtents;
+extern int freeExtentCount;
+extern memoryRegion *processRegions;
+extern int memoryFreeWords;
+extern int memoryCompactions;
+extern long long memoryWordsCompacted;
+extern PlacementPolicy placementPolicy;
+extern PlacementStats placementStats;
+extern bool pagedMemory;
+extern int pageSize;
+extern int frameCount;
+extern pageFrame* frames;
+extern bool demandPaging;
+extern PageReplacementPolicy pageReplacement;
+extern int pageFaultCycles;
+extern int workingSetWindow;
+extern SwapPolicy swapPolicy;
+extern SwapStats swapStats;
+extern FileIOStats fileIOStats;
+extern size_t writeBehindBytes;
+extern int writeBehindAge;
+extern bool syncWrites;
+extern bool simulatedFS;
+extern bool diskIO;
+extern int diskLatency;
+extern int diskBandwidth;
+extern int diskCylinders;
+extern int diskSeekRate;
+extern DiskSchedulingPolicy diskScheduling;
+extern DiskStats diskStats;
+extern ProgramCacheStats programCacheStats;
+extern bool shareText;
+extern bool fuseCriticalSections;
+extern DispatchStats dispatchStats;
 extern ProcessTableEntry* processTable;
+extern int processTableCapacity;
 extern int numProcesses;
 extern Queue readyQueue;
 extern MLFQScheduler mlfqScheduler;
 extern SchedulingAlgorithm algorithm;
 extern int currentTime;
 extern int processCount;
-extern Variable variables[];
-extern int var_count;
 extern Mutex fileMutex, inputMutex, outputMutex;
 extern PCB* currentRunningProcess;
 extern bool simulationPaused;
@@ -125,8 +504,60 @@ extern int currentProcessIndex;
 // Function declarations
 void initialize_simulation();
 int add_process(const char *filepath, int arrival_time);
+bool ensure_process_table_capacity(int needed);
 void check_for_process_arrivals(int currentTime);
 void initialMemory();
+int set_memory_size(int words);
+void memoryClear();
+int intern_name(const char* name);
+int intern_lookup(const char* name);
+const char* interned_name(int id);
+void memoryClearWord(int index);
+void memoryWriteString(int index, int processID, int nameID, const char* value);
+void memoryWriteText(int index, int processID, int nameID, const char* text);
+void memoryWriteInt(int index, int processID, int nameID, int64_t value);
+void memoryWriteValue(int index, int processID, int nameID, const char* value);
+void memoryWriteRope(int index, int processID, int nameID, Rope* rope);
+Rope* ropeReadFile(FILE* file);
+Rope* ropeRetain(Rope* rope);
+void ropeRelease(Rope* rope);
+const char* ropeText(Rope* rope);
+bool ropeWrite(const Rope* rope, FILE* file);
+const char* memoryWordText(int index);
+const char* memoryWordName(int index, char* buffer, size_t size);
+const char* memoryWordValue(int index, char* buffer, size_t size);
+void pcbMarkDirty(PCB* pcb, unsigned int fields);
+void pcbSetState(PCB* pcb, const char* state);
+void memorySyncPCB(PCB* pcb);
+void memorySyncAll();
+bool memoryStoreVariable(PCB* process, const char* varName, const char* value);
+bool memoryStoreVariableAt(PCB* process, int slot, int nameID, const Value* value);
+void memoryResetAllocator();
+int memoryAllocate(int processID, int IC);
+void memorydeallocate(int processID);
+int memoryUsedWords();
+int memoryNextUsedWord(int from);
+int memoryCompact();
+int memoryLargestFreeBlock();
+int set_placement_policy(PlacementPolicy policy);
+bool memoryMakeRoom(int words, PCB* keep);
+bool memorySwapOut(PCB* pcb);
+bool memorySwapIn(PCB* pcb);
+void memorySwapDiscard(PCB* pcb);
+void swapReset();
+void programCacheClear();
+int set_page_size(int words);
+bool memoryAllocateImage(PCB* pcb, int words);
+void memoryFreeImage(PCB* pcb);
+const char* memoryWordFrame(int index, char* buffer, size_t size);
+bool pcbPageLoaded(PCB* pcb, int offset);
+bool memoryTouchPage(PCB* pcb, int offset);
+void memoryPageFault(PCB* pcb);
+void check_page_fault_completions();
+void memoryReleaseProcess(PCB* pcb);
+int pcbAddress(PCB* pcb, int offset);
+int pcbImageWords(PCB* pcb);
+int pcbInstructionCount(PCB* pcb);
 int execute_step();
 bool all_processes_complete();
 bool load_process_file(const char *filepath, int arrival_time);
@@ -135,15 +566,37 @@ void set_scheduler_algorithm(int algorithm_index);
 void set_scheduler_quantum(int quantum);
 char* get_basename(const char* path);
 char* get_scheduler_stats_string();
+char* get_swap_stats_string();
+char* get_placement_stats_string();
+char* get_program_cache_stats_string();
+char* get_dispatch_stats_string();
+char* get_file_io_stats_string();
+bool writeBehindFlush();
+void writeBehindTick();
+void fileSystemImport(const char* directory);
+void fileSystemExport();
+void fileSystemClear();
+void check_disk_completions();
+void diskReset();
+char* get_disk_stats_string();
+char* get_disk_latency_string();
+char* get_paging_stats_string(PCB* process);
+void make_ready(PCB* process);
 void scheduler_log(const char* format, ...);
 char* get_process_state_string(PCB* process);
 void reset_simulation();
 void run_fcfs_step();
 void run_rr_step();
 void run_mlfq_step();
-void setVariable(const char* name, const char* value);
+void setVariable(PCB* process, const char* name, const char* value);
+Variable* findVariable(PCB* process, const char* name);
+int variableScopeSlot(VariableScope* scope, int nameID, bool create);
+bool variableScopeInit(VariableScope* scope, const uint16_t* names, int count);
+void variableScopeFree(VariableScope* scope);
+int isNumeric(const char* value);
 void getVariable(const char* name, char* value);
 void run_full_simulation();
+void parse_simulator_options(int *argc, char **argv);
 
 
 
@@ -0,0 +1,182 @@
+// Headless checks of the simulator's scheduling policies against traces
+// worked out by hand. scheduler.c is compiled in here so the checks can
+// drive its file-static policy code directly. Build and run with
+//   gcc $(pkg-config --cflags gtk4) scheduler_test.c -o scheduler_test $(pkg-config --libs gtk4)
+//   ./scheduler_test
+// It exits with 1 if any check fails.
+#include "scheduler.c"
+
+//================================ GUI Stand-ins ===========================
+
+SchedulerGUI *gui = NULL;
+
+void log_message(SchedulerGUI *view, const char *message) { (void)view; (void)message; }
+void add_output_message(SchedulerGUI *view, const char *message) { (void)view; (void)message; }
+void add_output_text(SchedulerGUI *view, const char *text, size_t length) { (void)view; (void)text; (void)length; }
+void add_output_rope(SchedulerGUI *view, const struct Rope *rope) { (void)view; (void)rope; }
+void output_line_begin(SchedulerGUI *view, OutputLine *line) { (void)view; (void)line; }
+void output_line_append(SchedulerGUI *view, OutputLine *line, const char *text, size_t length) { (void)view; (void)line; (void)text; (void)length; }
+void output_line_end(SchedulerGUI *view, OutputLine *line) { (void)view; (void)line; }
+void show_input_dialog(const char *var_name, bool numeric_only) { (void)var_name; (void)numeric_only; }
+void update_gui(SchedulerGUI *view) { (void)view; }
+
+//================================ Checks ===========================
+
+static int failedChecks = 0;
+
+// Compare the order a policy served things in, and what that cost, with
+// the expected trace
+static void check_trace(const char* name, const int* trace, int length, int cost, const char* unit,
+                        const int* expected, int expectedLength, int expectedCost) {
+    bool ok = length == expectedLength && cost == expectedCost;
+    printf("%s:", name);
+    for (int i = 0; i < length; i++) {
+        printf(" %d", trace[i]);
+        ok = ok && i < expectedLength && trace[i] == expected[i];
+    }
+    printf(", %d %s (expected %d) %s\n", cost, unit, expectedCost, ok ? "ok" : "FAILED");
+    failedChecks += !ok;
+}
+
+#define TRACE_MAX 32
+#define COUNT(array) ((int)(sizeof(array) / sizeof((array)[0])))
+
+//================================ Page Replacement ===========================
+
+#define REPLACEMENT_FRAMES 3
+
+// Run a reference string through frame_choose_victim on a table of
+// REPLACEMENT_FRAMES frames, one reference per time unit, recording each
+// evicted page. Returns the number of faults.
+static int replacement_trace(PageReplacementPolicy policy, int window, const int* refs, int count,
+                             int* evicted, int* evictions) {
+    static pageFrame table[REPLACEMENT_FRAMES];
+    for (int frame = 0; frame < REPLACEMENT_FRAMES; frame++) {
+        table[frame] = (pageFrame){ .owner = -1, .page = -1 };
+    }
+    frames = table;
+    frameCount = REPLACEMENT_FRAMES;
+    evictableFrames = 0;
+    clockHand = 0;
+    frameLoadCount = 0;
+    frameReferenceCount = 0;
+    pageReplacement = policy;
+    workingSetWindow = window;
+
+    int faults = 0;
+    *evictions = 0;
+    for (int i = 0; i < count; i++) {
+        currentTime = i;
+        int frame = -1;
+        for (int f = 0; f < REPLACEMENT_FRAMES; f++) {
+            if (table[f].owner != -1 && table[f].page == refs[i]) frame = f;
+        }
+        if (frame == -1) {
+            faults++;
+            for (int f = 0; f < REPLACEMENT_FRAMES && frame == -1; f++) {
+                if (table[f].owner == -1) frame = f;
+            }
+            if (frame == -1) {
+                frame = frame_choose_victim();
+                evicted[(*evictions)++] = table[frame].page;
+            } else {
+                evictableFrames++;
+            }
+            table[frame].owner = 0;
+            table[frame].page = refs[i];
+            table[frame].loadedAt = ++frameLoadCount;
+        }
+        // Reference it the way frame_assign and memoryTouchPage do
+        table[frame].lastUse = ++frameReferenceCount;
+        table[frame].lastUseTime = currentTime;
+        table[frame].referenced = true;
+    }
+    frames = NULL;
+    frameCount = 0;
+    evictableFrames = 0;
+    currentTime = 0;
+    return faults;
+}
+
+static void check_replacement(PageReplacementPolicy policy, int window, const int* refs, int count,
+                              const int* expected, int expectedLength, int expectedFaults) {
+    static const char* names[] = {"fifo", "lru", "clock", "working-set"};
+    int evicted[TRACE_MAX];
+    int evictions;
+    char name[64];
+    int faults = replacement_trace(policy, window, refs, count, evicted, &evictions);
+    snprintf(name, sizeof(name), "page replacement %s, evicting", names[policy]);
+    check_trace(name, evicted, evictions, faults, "faults", expected, expectedLength, expectedFaults);
+}
+
+// The textbook reference string with three frames
+static void check_page_replacement() {
+    static const int refs[] = {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2, 1, 2, 0, 1, 7, 0, 1};
+    static const int fifo[] = {7, 0, 1, 2, 3, 0, 4, 2, 3, 0, 1, 2};
+    static const int lru[] = {7, 1, 2, 3, 0, 4, 0, 3, 2};
+    static const int clock[] = {7, 1, 2, 0, 3, 4, 2, 0, 3, 1, 2};        // reference bit set on load
+    static const int workingSet[] = {7, 2, 3, 0, 4, 2, 0, 3, 0, 2};      // window of 1
+
+    check_replacement(REPLACE_FIFO, 0, refs, COUNT(refs), fifo, COUNT(fifo), 15);
+    check_replacement(REPLACE_LRU, 0, refs, COUNT(refs), lru, COUNT(lru), 12);
+    check_replacement(REPLACE_CLOCK, 0, refs, COUNT(refs), clock, COUNT(clock), 14);
+    check_replacement(REPLACE_WORKING_SET, 1, refs, COUNT(refs), workingSet, COUNT(workingSet), 13);
+}
+
+//================================ Disk Scheduling ===========================
+
+// Serve a fixed queue from an idle disk, recording each cylinder in turn.
+// Returns the cylinders the head travelled.
+static int disk_trace(DiskSchedulingPolicy policy, int head, const int* cylinders, int count, int* trace) {
+    diskReset();
+    diskScheduling = policy;
+    diskHead = head;
+    DiskRequest** tail = &diskQueue;
+    for (int i = 0; i < count; i++) {
+        DiskRequest* request = (DiskRequest*)calloc(1, sizeof(DiskRequest));
+        request->cylinder = cylinders[i];
+        *tail = request;
+        tail = &request->next;
+    }
+    int travel = 0;
+    for (int i = 0; diskQueue != NULL; i++) {
+        DiskRequest* request = disk_pick(&travel);
+        trace[i] = request->cylinder;
+        free(request);
+    }
+    return travel;
+}
+
+static void check_disk(DiskSchedulingPolicy policy, int head, const int* cylinders, int count,
+                       const int* expected, int expectedTravel) {
+    int trace[TRACE_MAX];
+    char name[64];
+    int travel = disk_trace(policy, head, cylinders, count, trace);
+    snprintf(name, sizeof(name), "disk %s from %d", diskPolicyNames[policy], head);
+    check_trace(name, trace, count, travel, "cylinders", expected, count, expectedTravel);
+}
+
+// The textbook queue on a 200-cylinder disk with the head at 53
+static void check_disk_scheduling() {
+    static const int queue[] = {98, 183, 37, 122, 14, 124, 65, 67};
+    static const int fcfs[] = {98, 183, 37, 122, 14, 124, 65, 67};
+    static const int sstf[] = {65, 67, 37, 14, 98, 122, 124, 183};
+    static const int scan[] = {65, 67, 98, 122, 124, 183, 37, 14};    // up to 199, then back
+    static const int clook[] = {65, 67, 98, 122, 124, 183, 14, 37};   // wraps to the lowest
+    static const int tie[] = {40, 60};                                // equal distance: queued first
+
+    diskCylinders = 200;
+    check_disk(DISK_FCFS, 53, queue, COUNT(queue), fcfs, 640);
+    check_disk(DISK_SSTF, 53, queue, COUNT(queue), sstf, 236);
+    check_disk(DISK_SCAN, 53, queue, COUNT(queue), scan, 331);
+    check_disk(DISK_CLOOK, 53, queue, COUNT(queue), clook, 322);
+    check_disk(DISK_SSTF, 50, tie, COUNT(tie), tie, 30);
+    diskReset();
+}
+
+int main() {
+    check_page_replacement();
+    check_disk_scheduling();
+    printf("%d checks failed\n", failedChecks);
+    return failedChecks ? 1 : 0;
+}